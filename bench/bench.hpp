@@ -0,0 +1,199 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef BENCH_BENCH_HPP
+#define BENCH_BENCH_HPP
+
+/* External includes */
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+
+/*================================================================================*/
+/*                                   Definitions                                  */
+/*================================================================================*/
+
+	/* Keeps the compiler from dropping a result it can see is unused */
+	template<typename T>
+	void keep(const T & value);
+
+	/* Times benchmarks and prints one row per metric as BENCH_FORMAT says:
+	 *   text (default)  suite/benchmark: metric value unit
+	 *   csv             suite,benchmark,metric,value,unit
+	 *   json            {"suite": ..., "benchmark": ..., ...}, one object per line
+	 * db<> output goes to std::cout too: it is muted while the runner lives. */
+	class Runner
+	{
+	public:
+		enum class Format {Text, CSV, JSON};
+
+		explicit Runner(const std::string & suite);
+		~Runner();
+
+		/* Times f, which does items operations per call: median and minimum
+		 * of BENCH_SAMPLES samples of at least BENCH_MIN_MS each. */
+		template<typename F>
+		void run(const std::string & name, size_t items, const F & f);
+
+		/* Times f once per sample, for slow macro benchmarks: returns the
+		 * median, in milliseconds */
+		template<typename F>
+		double run_once(const std::string & name, const F & f);
+
+		void report(const std::string & name, const std::string & metric, double value, const std::string & unit);
+
+	private:
+		struct Null : public std::streambuf
+		{
+			int overflow(int c) override { return c; }
+		};
+
+		template<typename F>
+		double sample(size_t iterations, const F & f);
+
+		Null _null;
+		std::streambuf * _cout;
+		std::ostream _out;
+
+		std::string _suite;
+		Format _format{Format::Text};
+		int _samples{7};
+		double _min_ms{20};
+	};
+
+/*================================================================================*/
+/*                                 Implementaions                                 */
+/*================================================================================*/
+
+	template<typename T>
+	void keep(const T & value)
+	{
+		asm volatile("" : : "r"(&value) : "memory");
+	}
+
+	Runner::Runner(const std::string & suite) :
+		_cout(std::cout.rdbuf(&_null)),
+		_out(_cout),
+		_suite(suite)
+	{
+		if (const char * format = std::getenv("BENCH_FORMAT"))
+		{
+			if (!std::strcmp(format, "csv"))
+				_format = Format::CSV;
+			else if (!std::strcmp(format, "json"))
+				_format = Format::JSON;
+		}
+
+		if (const char * samples = std::getenv("BENCH_SAMPLES"))
+			_samples = std::max(1, std::atoi(samples));
+
+		if (const char * min_ms = std::getenv("BENCH_MIN_MS"))
+			_min_ms = std::max(0.0, std::atof(min_ms));
+	}
+
+	Runner::~Runner()
+	{
+		std::cout.rdbuf(_cout);
+	}
+
+	//! Milliseconds taken by iterations calls of f
+	template<typename F>
+	double Runner::sample(size_t iterations, const F & f)
+	{
+		auto begin = std::chrono::steady_clock::now();
+
+		for (size_t i = 0; i < iterations; ++i)
+			f();
+
+		auto end = std::chrono::steady_clock::now();
+
+		return std::chrono::duration<double, std::milli>(end - begin).count();
+	}
+
+	template<typename F>
+	void Runner::run(const std::string & name, size_t items, const F & f)
+	{
+		/* Grows the iterations until one sample lasts long enough */
+		size_t iterations = 1;
+
+		for (double ms = sample(iterations, f); ms < _min_ms && iterations < (size_t(1) << 40); ms = sample(iterations, f))
+			iterations *= ms > 0 ? std::max<size_t>(2, std::min<size_t>(100, 1.2 * _min_ms / ms)) : 100;
+
+		std::vector<double> ns;
+
+		for (int s = 0; s < _samples; ++s)
+			ns.push_back(sample(iterations, f) * 1e6 / (double(iterations) * items));
+
+		std::sort(ns.begin(), ns.end());
+
+		report(name, "median", ns[ns.size() / 2], "ns/op");
+		report(name, "min", ns.front(), "ns/op");
+	}
+
+	template<typename F>
+	double Runner::run_once(const std::string & name, const F & f)
+	{
+		std::vector<double> ms;
+
+		for (int s = 0; s < _samples; ++s)
+			ms.push_back(sample(1, f));
+
+		std::sort(ms.begin(), ms.end());
+
+		report(name, "median", ms[ms.size() / 2], "ms");
+		report(name, "min", ms.front(), "ms");
+
+		return ms[ms.size() / 2];
+	}
+
+	void Runner::report(const std::string & name, const std::string & metric, double value, const std::string & unit)
+	{
+		switch (_format)
+		{
+		case Format::CSV:
+			_out << _suite << "," << name << "," << metric << "," << value << "," << unit << std::endl;
+			break;
+
+		case Format::JSON:
+			_out << "{\"suite\": \"" << _suite << "\", \"benchmark\": \"" << name
+			          << "\", \"metric\": \"" << metric << "\", \"value\": " << value
+			          << ", \"unit\": \"" << unit << "\"}" << std::endl;
+			break;
+
+		default:
+			_out << _suite << "/" << name << ": " << metric << " " << value << " " << unit << std::endl;
+			break;
+		}
+	}
+
+} //! namespace bench
+
+#endif  // BENCH_BENCH_HPP
@@ -0,0 +1,127 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* External includes */
+#include <memory>
+#include <random>
+#include <vector>
+
+/* Local includes */
+#include "../src/model/line.hpp"
+#include "../src/model/polygon.hpp"
+#include "../src/model/segments.hpp"
+#include "bench.hpp"
+
+/* Line clipping under both methods, the same segments in one batch and
+ * polygon clipping, over a mix of inside, crossing and outside shapes. Each
+ * operation rebuilds its input first (clipping consumes it): see the
+ * w_transformation and segments_add rows. */
+int main()
+{
+	bench::Runner runner("clipping");
+
+	const size_t shapes = 1000;
+	const model::Vector cmin{-0.95, -0.95}, cmax{0.95, 0.95};
+	const model::Matrix I;
+
+	std::mt19937 random(42);
+	std::uniform_real_distribution<double> coordinate(-2, 2);
+
+	std::vector<std::unique_ptr<model::Line>> lines;
+	std::vector<std::unique_ptr<model::Polygon>> polygons;
+	std::vector<model::Vector> ends;
+
+	for (size_t i = 0; i < shapes; ++i)
+	{
+		ends.emplace_back(coordinate(random), coordinate(random));
+		ends.emplace_back(coordinate(random), coordinate(random));
+		lines.emplace_back(new model::Line("line", ends[2 * i], ends[2 * i + 1]));
+
+		std::vector<model::Vector> vs;
+		model::Vector center(coordinate(random), coordinate(random));
+
+		for (int k = 0; k < 8; ++k)
+			vs.emplace_back(center[0] + std::cos(k * M_PI / 4), center[1] + std::sin(k * M_PI / 4));
+
+		polygons.emplace_back(new model::Polygon("polygon", vs));
+	}
+
+	runner.run("line_w_transformation", shapes, [&]() {
+		for (auto & line : lines)
+			line->w_transformation(I);
+	});
+
+	model::Line::clipping_method = model::Line::ClippingMethod::Cohen_Sutherland;
+
+	runner.run("line_cohen_sutherland", shapes, [&]() {
+		for (auto & line : lines)
+		{
+			line->w_transformation(I);
+			line->clipping(cmin, cmax);
+		}
+	});
+
+	model::Line::clipping_method = model::Line::ClippingMethod::Liang_Barsky;
+
+	runner.run("line_liang_barsky", shapes, [&]() {
+		for (auto & line : lines)
+		{
+			line->w_transformation(I);
+			line->clipping(cmin, cmax);
+		}
+	});
+
+	runner.run("segments_add", shapes, [&]() {
+		model::Segments segments;
+
+		for (size_t i = 0; i < shapes; ++i)
+			segments.add(ends[2 * i], ends[2 * i + 1]);
+
+		bench::keep(segments.size());
+	});
+
+	runner.run("segments_batch_clip", shapes, [&]() {
+		model::Segments segments;
+
+		for (size_t i = 0; i < shapes; ++i)
+			segments.add(ends[2 * i], ends[2 * i + 1]);
+
+		segments.clip(cmin, cmax);
+		bench::keep(segments.size());
+	});
+
+	runner.run("polygon_w_transformation", shapes, [&]() {
+		for (auto & polygon : polygons)
+			polygon->w_transformation(I);
+	});
+
+	runner.run("polygon_sutherland_hodgeman", shapes, [&]() {
+		for (auto & polygon : polygons)
+		{
+			polygon->w_transformation(I);
+			polygon->clipping(cmin, cmax);
+		}
+	});
+
+	return 0;
+}
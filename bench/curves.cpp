@@ -0,0 +1,180 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* External includes */
+#include <cmath>
+#include <vector>
+
+/* Local includes */
+#include "../src/model/b_spline.hpp"
+#include "../src/model/b_spline_surface.hpp"
+#include "../src/model/bezier.hpp"
+#include "../src/model/bezier_surface.hpp"
+#include "../src/model/frame.hpp"
+#include "../src/model/tessellation.hpp"
+#include "bench.hpp"
+
+/* Curve and surface tessellation, cached in world space: *_w_transformation
+ * is a frame that only moves the cached points, *_tessellate one after the
+ * controls changed. The curves are also tessellated under both methods at a
+ * few on-screen sizes of an 800 x 600 viewport, with the vertices each emits. */
+int main()
+{
+	bench::Runner runner("curves");
+
+	const model::Matrix T = model::transformation::rotation(0.3, {0, 0, 0}, {0.2, 1, 0.1})
+	                      * model::transformation::scaling(0.01, {0, 0, 0});
+
+	/* 10 connected bezier segments, and a b-spline over as many controls */
+	std::vector<model::Vector> controls;
+
+	for (int i = 0; i < 31; ++i)
+		controls.emplace_back(10 * i, 50 * std::sin(i), 10 * std::cos(i));
+
+	model::Bezier bezier("bezier", controls);
+	model::BSpline b_spline("b_spline", controls);
+
+	//! Touches the controls, dropping the cached tessellation
+	const model::Matrix identity = model::transformation::translation({0, 0, 0});
+
+	runner.run("bezier_w_transformation", 1, [&]() {
+		bezier.w_transformation(T);
+	});
+
+	runner.run("b_spline_w_transformation", 1, [&]() {
+		b_spline.w_transformation(T);
+	});
+
+	runner.run("bezier_tessellate", 1, [&]() {
+		bezier.transformation(identity);
+		bezier.w_transformation(T);
+	});
+
+	runner.run("b_spline_tessellate", 1, [&]() {
+		b_spline.transformation(identity);
+		b_spline.w_transformation(T);
+	});
+
+	model::Tessellation::viewport(800, 600);
+
+	/* Controls span 300 units in x: from a few pixels to the whole width */
+	const std::vector<std::pair<std::string, double>> sizes{
+		{"4px", 4 * 2.0 / 800 / 300}, {"80px", 80 * 2.0 / 800 / 300}, {"800px", 2.0 / 300}
+	};
+
+	using Method = model::Tessellation::Method;
+
+	for (auto method : {Method::Uniform, Method::Adaptive})
+	{
+		model::Tessellation::method = method;
+
+		for (auto & size : sizes)
+		{
+			const model::Matrix S = model::transformation::rotation(0.3, {0, 0, 0}, {0.2, 1, 0.1})
+			                      * model::transformation::scaling(size.second, {0, 0, 0});
+
+			const std::string suffix = (method == Method::Uniform ? "_uniform_" : "_adaptive_") + size.first;
+
+			for (model::Shape * curve : {static_cast<model::Shape *>(&bezier), static_cast<model::Shape *>(&b_spline)})
+			{
+				const std::string name = (curve == &bezier ? "bezier" : "b_spline") + suffix;
+
+				runner.run(name, 1, [&]() {
+					curve->transformation(identity);
+					curve->w_transformation(S);
+				});
+
+				model::Frame frame;
+				curve->draw(frame);
+				runner.report(name, "vertices", frame.points(), "vertices");
+			}
+		}
+	}
+
+	model::Tessellation::method = Method::Adaptive;
+
+	/* One bicubic patch, and a 7 x 7 grid (4 b-spline patches per axis) */
+	auto grid = [](int size) {
+		std::vector<std::vector<model::Vector>> vs(size);
+
+		for (int i = 0; i < size; ++i)
+			for (int j = 0; j < size; ++j)
+				vs[i].emplace_back(25 * i, 25 * j, 50 * std::sin(i + j));
+
+		return vs;
+	};
+
+	model::BezierSurface bezier_surface("bezier_surface", grid(4));
+	model::BSplineSurface b_spline_surface("b_spline_surface", grid(7));
+
+	runner.run("bezier_surface_w_transformation", 1, [&]() {
+		bezier_surface.w_transformation(T);
+	});
+
+	runner.run("b_spline_surface_w_transformation", 1, [&]() {
+		b_spline_surface.w_transformation(T);
+	});
+
+	runner.run("bezier_surface_tessellate", 1, [&]() {
+		bezier_surface.transformation(identity);
+		bezier_surface.w_transformation(T);
+	});
+
+	runner.run("b_spline_surface_tessellate", 1, [&]() {
+		b_spline_surface.transformation(identity);
+		b_spline_surface.w_transformation(T);
+	});
+
+	/* A frame of each surface past w_transformation, over its flat polylines */
+	const model::Vector min{-0.95, -0.95}, max{0.95, 0.95};
+
+	for (model::Shape * surface : {static_cast<model::Shape *>(&bezier_surface), static_cast<model::Shape *>(&b_spline_surface)})
+	{
+		const std::string name = surface == &bezier_surface ? "bezier_surface_frame" : "b_spline_surface_frame";
+
+		runner.run(name, 1, [&]() {
+			model::Frame frame;
+
+			surface->w_transformation(T);
+			surface->perspective();
+			surface->clipping(min, max);
+			surface->draw(frame);
+		});
+	}
+
+	/* The densest grids the surface dialog takes: patches tessellate in parallel */
+	model::BezierSurface dense_bezier_surface("dense_bezier_surface", grid(19));
+	model::BSplineSurface dense_b_spline_surface("dense_b_spline_surface", grid(20));
+
+	runner.run("bezier_surface_19x19_tessellate", 1, [&]() {
+		dense_bezier_surface.transformation(identity);
+		dense_bezier_surface.w_transformation(T);
+	});
+
+	runner.run("b_spline_surface_20x20_tessellate", 1, [&]() {
+		dense_b_spline_surface.transformation(identity);
+		dense_b_spline_surface.w_transformation(T);
+	});
+
+	return 0;
+}
@@ -0,0 +1,202 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* External includes */
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+/* Local includes */
+#include "../src/model/line.hpp"
+#include "bench.hpp"
+
+/* Logging types: one compiled out, one compiled in */
+struct Quiet {};
+struct Loud {};
+
+template<> struct Traits<Quiet> : public Traits<void>
+{
+    static const bool debugged = false;
+};
+
+template<> struct Traits<Loud> : public Traits<void>
+{
+    static const bool debugged = true;
+};
+
+namespace
+{
+	struct Segment
+	{
+		double x0, y0, x1, y1;
+	};
+
+	int outcode(double x, double y)
+	{
+		return (x < -0.95) | (x > 0.95) << 1 | (y < -0.95) << 2 | (y > 0.95) << 3;
+	}
+
+	//! Trivial accepts, without any logging
+	int accept(const std::vector<Segment> & segments)
+	{
+		int accepted = 0;
+
+		for (auto & s : segments)
+			accepted += !(outcode(s.x0, s.y0) | outcode(s.x1, s.y1));
+
+		return accepted;
+	}
+
+	//! The same, logging each segment like Line::cohen_sutherland does
+	template<typename T>
+	int accept_logged(const std::vector<Segment> & segments)
+	{
+		int accepted = 0;
+
+		for (auto & s : segments)
+		{
+			db<T>(INF) << "[" << &s << "] Cohen Sutherland" << std::endl;
+			accepted += !(outcode(s.x0, s.y0) | outcode(s.x1, s.y1));
+		}
+
+		return accepted;
+	}
+
+	//! Formatting a message argument, counted: a side effect no optimizer drops
+	size_t evaluations = 0;
+
+	std::string describe(const Segment & s)
+	{
+		++evaluations;
+		return std::to_string(s.x0) + ", " + std::to_string(s.y0) + " -> " + std::to_string(s.x1) + ", " + std::to_string(s.y1);
+	}
+
+	//! Logs a formatted segment through db<>(), which always formats it
+	template<typename T>
+	void describe_db(const std::vector<Segment> & segments)
+	{
+		for (auto & s : segments)
+			db<T>(INF) << describe(s) << std::endl;
+	}
+
+	//! The same through DB(), which formats only what prints
+	template<typename T>
+	void describe_guarded(const std::vector<Segment> & segments)
+	{
+		for (auto & s : segments)
+			DB(T, INF) << describe(s) << std::endl;
+	}
+}
+
+/* What db<>() costs inside a clipping loop: compiled out must match the loop
+ * without logging, a runtime level below INF costs one load and branch per
+ * message, and printing (to a muted std::cout) is the formatting alone. DB()
+ * also skips the arguments db<>() evaluates whatever the level. */
+int main()
+{
+	bench::Runner runner("debug");
+
+	const size_t shapes = 1000;
+	const model::Vector cmin{-0.95, -0.95}, cmax{0.95, 0.95};
+	const model::Matrix I;
+	const int level = Debug::level();
+
+	std::mt19937 random(42);
+	std::uniform_real_distribution<double> coordinate(-2, 2);
+
+	std::vector<Segment> segments;
+	std::vector<std::unique_ptr<model::Line>> lines;
+
+	for (size_t i = 0; i < shapes; ++i)
+	{
+		segments.push_back({coordinate(random), coordinate(random), coordinate(random), coordinate(random)});
+		lines.emplace_back(new model::Line("line", model::Vector(segments.back().x0, segments.back().y0),
+		                                           model::Vector(segments.back().x1, segments.back().y1)));
+	}
+
+	runner.run("accept_without_db", shapes, [&]() {
+		bench::keep(accept(segments));
+	});
+
+	runner.run("accept_compiled_out", shapes, [&]() {
+		bench::keep(accept_logged<Quiet>(segments));
+	});
+
+	Debug::level(ERR);
+
+	runner.run("accept_level_err", shapes, [&]() {
+		bench::keep(accept_logged<Loud>(segments));
+	});
+
+	Debug::level(TRC);
+
+	runner.run("accept_level_trc", shapes, [&]() {
+		bench::keep(accept_logged<Loud>(segments));
+	});
+
+	/* Arguments with side effects: db<>() evaluates them even compiled out,
+	 * DB() only when the message prints. Reported per message logged. */
+	for (int l : {int(ERR), int(TRC)})
+	{
+		const std::string level = l == ERR ? "_level_err" : "_level_trc";
+
+		Debug::level(l);
+
+		auto describe_run = [&](const std::string & name, void (*f)(const std::vector<Segment> &)) {
+			size_t calls = 0;
+
+			evaluations = 0;
+			runner.run(name + level, shapes, [&]() {
+				f(segments);
+				++calls;
+			});
+			runner.report(name + level, "evaluations", double(evaluations) / (calls * shapes), "per message");
+		};
+
+		describe_run("describe_db_compiled_out", describe_db<Quiet>);
+		describe_run("describe_guarded_compiled_out", describe_guarded<Quiet>);
+		describe_run("describe_db", describe_db<Loud>);
+		describe_run("describe_guarded", describe_guarded<Loud>);
+	}
+
+	/* Line::clipping with its DB(Line, INF) filtered at runtime, then printed */
+	model::Line::clipping_method = model::Line::ClippingMethod::Liang_Barsky;
+
+	for (int l : {int(ERR), int(TRC)})
+	{
+		Debug::level(l);
+
+		runner.run(l == ERR ? "line_liang_barsky_level_err" : "line_liang_barsky_level_trc", shapes, [&]() {
+			for (auto & line : lines)
+			{
+				line->w_transformation(I);
+				line->clipping(cmin, cmax);
+			}
+		});
+	}
+
+	Debug::level(level);
+
+	return 0;
+}
@@ -0,0 +1,68 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* External includes */
+#include <vector>
+
+/* Local includes */
+#include "../src/model/geometry.hpp"
+#include "bench.hpp"
+
+/* Vector and Matrix products and the transformation builders */
+int main()
+{
+	bench::Runner runner("geometry");
+
+	model::Matrix A = model::transformation::rotation(0.5, {10, 20, 30}, {10, 20, 31});
+	model::Matrix B = model::transformation::scaling(1.5, {1, 2, 3});
+	model::Vector v(1, 2, 3);
+
+	runner.run("vector_times_matrix", 1, [&]() {
+		v[0] += 1e-9;
+		bench::keep(v * A);
+	});
+
+	runner.run("matrix_times_matrix", 1, [&]() {
+		B[3][0] += 1e-9;
+		bench::keep(A * B);
+	});
+
+	double angle = 0.5;
+
+	runner.run("rotation", 1, [&]() {
+		angle += 1e-9;
+		bench::keep(model::transformation::rotation(angle, {10, 20, 30}, {11, 22, 33}));
+	});
+
+	runner.run("translation", 1, [&]() {
+		v[1] += 1e-9;
+		bench::keep(model::transformation::translation(v));
+	});
+
+	runner.run("scaling", 1, [&]() {
+		v[2] += 1e-9;
+		bench::keep(model::transformation::scaling(1.5, v));
+	});
+
+	return 0;
+}
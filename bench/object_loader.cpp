@@ -0,0 +1,55 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* External includes */
+#include <memory>
+#include <string>
+#include <vector>
+
+/* Local includes */
+#include "../src/control/object_loader.hpp"
+#include "bench.hpp"
+
+/* Parsing the OBJ text against reloading its SceneCache */
+int main(int argc, char ** argv)
+{
+	bench::Runner runner("object_loader");
+
+	const std::string path = argc > 1 ? argv[1] : "load/bowler/bowler.obj";
+
+	control::ObjectLoader loader;
+
+	runner.run_once("parse", [&]() {
+		sys::MappedFile file(path);
+		bench::keep(loader.parse(file.data(), file.data() + file.size()));
+	});
+
+	loader.load(path, {0, 0, 0}, {0, 0, 0});
+
+	runner.run_once("cache", [&]() {
+		std::vector<std::shared_ptr<model::Shape>> shapes;
+		control::SceneCache::read(control::SceneCache::path_of(path), shapes);
+	});
+
+	return 0;
+}
@@ -0,0 +1,82 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* External includes */
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+/* Local includes */
+#include "../src/control/object_loader.hpp"
+#include "bench.hpp"
+
+/* Parses a model copied several times over pools of 1, 2, 4 ... threads */
+int main(int argc, char ** argv)
+{
+	bench::Runner runner("object_loader_scaling");
+
+	const std::string source = argc > 1 ? argv[1] : "load/bowler/bowler.obj";
+	const int copies = argc > 2 ? std::atoi(argv[2]) : 16;
+
+	std::ifstream input(source, std::ios::binary);
+	const std::string model((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+	std::string text;
+	for (int i = 0; i < copies; ++i)
+		text += "o copy" + std::to_string(i) + "\n" + model + "\n";
+
+	const double mb = text.size() / 1e6;
+	const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+
+	double serial = 0;
+
+	for (unsigned threads = 1; threads <= std::max(cores, 4u); threads *= 2)
+	{
+		sys::ThreadPool pool(threads);
+		control::ObjectLoader loader(pool);
+
+		double best = 0;
+
+		for (int i = 0; i < 3; ++i)
+		{
+			auto begin = std::chrono::steady_clock::now();
+			bench::keep(loader.parse(text.data(), text.data() + text.size(), 8 * threads));
+			auto end = std::chrono::steady_clock::now();
+
+			double ms = std::chrono::duration<double, std::milli>(end - begin).count();
+			best = i ? std::min(best, ms) : ms;
+		}
+
+		if (threads == 1)
+			serial = best;
+
+		const std::string name = "parse_" + std::to_string(threads) + "_threads";
+
+		runner.report(name, "min", best, "ms");
+		runner.report(name, "throughput", mb / best * 1e3, "MB/s");
+		runner.report(name, "speedup", serial / best, "x");
+	}
+
+	return 0;
+}
@@ -0,0 +1,145 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* External includes */
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* Local includes */
+#include "../src/control/object_loader.hpp"
+#include "../src/control/renderer.hpp"
+#include "../src/model/frame.hpp"
+#include "../src/model/polygon.hpp"
+#include "../src/model/raster.hpp"
+#include "../src/model/window.hpp"
+#include "../src/sys/mapped_file.hpp"
+#include "bench.hpp"
+
+/* Whole scenes: OBJ parsing, then the build and render passes of every
+ * frame, with the window moving so every shape is rebuilt each time, and
+ * the paint of the frame onto an 800 x 600 image, by Cairo and by Raster.
+ * Frames are also rendered with back faces culled. */
+int main(int argc, char ** argv)
+{
+	bench::Runner runner("pipeline");
+
+	std::vector<std::string> models{"load/basicman/basicman.obj", "load/bowler/bowler.obj"};
+
+	if (argc > 1)
+		models.assign(argv + 1, argv + argc);
+
+	for (auto & path : models)
+	{
+		std::string name = path.substr(path.find_last_of('/') + 1);
+		name = name.substr(0, name.find_last_of('.'));
+
+		control::ObjectLoader loader;
+		sys::MappedFile file(path);
+		std::vector<std::shared_ptr<model::Shape>> shapes;
+
+		runner.run_once(name + "_parse", [&]() {
+			shapes = loader.parse(file.data(), file.data() + file.size());
+		});
+
+		model::Window window(model::Vector(-400, -300, 0), model::Vector(400, 300, 0));
+		control::Renderer renderer(window);
+
+		const model::Matrix step = model::transformation::rotation(0.01, {0, 0, 0}, {0, 1, 0});
+
+		runner.run_once(name + "_build", [&]() {
+			window.transformation(step);
+			renderer.build(shapes);
+		});
+
+		model::Frame frame;
+
+		runner.run_once(name + "_render", [&]() {
+			window.transformation(step);
+			frame.clear();
+			renderer.render(shapes, frame);
+		});
+
+		auto surface = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, 800, 600);
+		auto cr = Cairo::Context::create(surface);
+
+		const model::Matrix viewport_T = model::transformation::viewport_transformation(
+			model::Vector(0, 0), model::Vector(800, 600), model::Window::fixed_min, model::Window::fixed_max
+		);
+
+		runner.run_once(name + "_paint", [&]() {
+			frame.draw(cr, viewport_T);
+		});
+
+		runner.report(name + "_paint", "segments", frame.segments(), "segments");
+
+		model::Raster raster;
+
+		runner.run_once(name + "_paint_raster", [&]() {
+			raster.draw(cr, frame, viewport_T, 800, 600);
+		});
+
+		runner.report(name + "_paint_raster", "segments", frame.segments(), "segments");
+
+		/* Faces turned away are neither clipped nor drawn: about half of a closed mesh */
+		model::Polygon::back_face_culling = true;
+
+		runner.run_once(name + "_render_culled", [&]() {
+			window.transformation(step);
+			frame.clear();
+			renderer.render(shapes, frame);
+		});
+
+		runner.report(name + "_render_culled", "segments", frame.segments(), "segments");
+
+		model::Polygon::back_face_culling = false;
+
+		/* Zoomed on the middle of the scene until it spans 10 windows, as when
+		 * inspecting a detail: culling leaves most shapes out. Moves one pixel
+		 * back and forth. */
+		model::Box bounds;
+
+		for (auto & shape : shapes)
+			bounds.extend(shape->bounds());
+
+		const model::Box seen = bounds.transformed(window.transformation());
+		const double extent = std::max(seen.max()[0] - seen.min()[0], seen.max()[1] - seen.min()[1]);
+		const model::Vector center(seen.center(0), seen.center(1), seen.center(2));
+
+		window.transformation(model::transformation::translation(-1 * center));
+		window.transformation(model::transformation::scaling(10 * 600 / extent, {0, 0, 0}));
+
+		double dx = 1;
+
+		runner.run_once(name + "_render_zoomed", [&]() {
+			window.transformation(model::transformation::translation({dx, 0, 0}));
+			dx = -dx;
+
+			frame.clear();
+			renderer.render(shapes, frame);
+		});
+	}
+
+	return 0;
+}
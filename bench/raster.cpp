@@ -0,0 +1,101 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* External includes */
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* Local includes */
+#include "../src/control/object_loader.hpp"
+#include "../src/control/renderer.hpp"
+#include "../src/model/frame.hpp"
+#include "../src/model/raster.hpp"
+#include "../src/model/window.hpp"
+#include "../src/sys/mapped_file.hpp"
+#include "bench.hpp"
+
+/* Frames of whole scenes turned into an 800 x 600 image, by Raster and by
+ * Cairo: as wireframes, then solid, with faces filled through the z-buffer.
+ * Solid rows also report the triangles filled per second. */
+int main(int argc, char ** argv)
+{
+	bench::Runner runner("raster");
+
+	std::vector<std::string> models{"load/basicman/basicman.obj", "load/bowler/bowler.obj"};
+
+	if (argc > 1)
+		models.assign(argv + 1, argv + argc);
+
+	auto surface = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, 800, 600);
+	auto cr = Cairo::Context::create(surface);
+
+	const model::Matrix viewport_T = model::transformation::viewport_transformation(
+		model::Vector(0, 0), model::Vector(800, 600), model::Window::fixed_min, model::Window::fixed_max
+	);
+
+	for (auto & path : models)
+	{
+		std::string name = path.substr(path.find_last_of('/') + 1);
+		name = name.substr(0, name.find_last_of('.'));
+
+		for (bool filled : {false, true})
+		{
+			control::ObjectLoader::filled = filled;
+
+			control::ObjectLoader loader;
+			sys::MappedFile file(path);
+			auto shapes = loader.parse(file.data(), file.data() + file.size());
+
+			model::Window window(model::Vector(-400, -300, 0), model::Vector(400, 300, 0));
+			control::Renderer renderer(window);
+
+			model::Frame frame;
+			renderer.render(shapes, frame);
+
+			const std::string row = name + (filled ? "_solid" : "_wireframe");
+			model::Raster raster;
+
+			const double ms = runner.run_once(row, [&]() {
+				raster.rasterize(frame, viewport_T, 800, 600);
+			});
+
+			runner.report(row, "segments", frame.segments(), "segments");
+
+			if (filled)
+			{
+				runner.report(row, "triangles", raster.triangles(), "triangles");
+				runner.report(row, "throughput", raster.triangles() / (ms * 1e3), "Mtri/s");
+			}
+
+			runner.run_once(row + "_cairo", [&]() {
+				frame.draw(cr, viewport_T);
+			});
+		}
+	}
+
+	control::ObjectLoader::filled = false;
+
+	return 0;
+}
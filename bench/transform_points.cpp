@@ -0,0 +1,65 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* External includes */
+#include <cstring>
+#include <vector>
+
+/* Local includes */
+#include "../src/model/kernel.hpp"
+#include "bench.hpp"
+
+/* Per vertex Vector*Matrix against the batch kernels, which must agree bit for bit */
+int main()
+{
+	bench::Runner runner("transform_points");
+
+	const size_t vertices = 100000;
+
+	model::Matrix T = model::transformation::rotation(0.5, {10, 20, 30}, {10, 20, 31})
+	                * model::transformation::translation({1, 2, 3});
+
+	std::vector<model::Vector> in, expected(vertices), out(vertices);
+
+	for (size_t i = 0; i < vertices; ++i)
+		in.emplace_back(i, 2.0 * i, 0.5 * i);
+
+	runner.run("vector_times_matrix", vertices, [&]() {
+		for (size_t i = 0; i < vertices; ++i)
+			expected[i] = in[i] * T;
+	});
+
+	runner.run("scalar", vertices, [&]() {
+		model::kernel::scalar(T, &in[0][0], &out[0][0], vertices);
+	});
+
+	runner.run(model::kernel::name(), vertices, [&]() {
+		model::kernel::transform_points(T, in, out);
+	});
+
+	bool identical = !std::memcmp(&out[0][0], &expected[0][0], vertices * sizeof(model::Vector));
+
+	runner.report(model::kernel::name(), "identical", identical, "bool");
+
+	return identical ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* External includes */
+#include <cstdlib>
+#include <new>
+
+/* Local includes */
+#include "../src/model/geometry.hpp"
+#include "bench.hpp"
+
+/* Counts every global allocation made while the benchmark runs */
+static size_t allocations = 0;
+
+void * operator new(size_t size)
+{
+	++allocations;
+
+	if (void * p = std::malloc(size))
+		return p;
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void * p) noexcept
+{
+	std::free(p);
+}
+
+int main()
+{
+	bench::Runner runner("vector_allocations");
+
+	const size_t vertices = 1000000;
+
+	model::Matrix T = model::transformation::rotation(0.5, {10, 20, 30}, {10, 20, 31})
+	                * model::transformation::scaling(1.5, {0, 0, 0})
+	                * model::transformation::translation({1, 2, 3});
+
+	model::Vector v(1, 2, 3);
+	double checksum = 0;
+
+	allocations = 0;
+
+	for (size_t i = 0; i < vertices; ++i)
+	{
+		v[0] = i;
+		checksum += (v * T)[0];
+	}
+
+	bench::keep(checksum);
+	runner.report("vector_times_matrix", "allocations", double(allocations) / vertices, "allocs/op");
+
+	return 0;
+}
@@ -1,10 +1,15 @@
 #include <gtkmm.h>
+#include <cstdlib>
 #include <iostream>
 
 #include "src/control/main_control.hpp"
 
 int main(int argc, char **argv)
 {
+	/* DEBUG_LEVEL=1 (errors) .. 4 (traces) filters the messages compiled in */
+	if (const char * level = std::getenv("DEBUG_LEVEL"))
+		Debug::level(std::atoi(level));
+
 	Gtk::Window *main_window{nullptr};
 	control::MainControl *main_control{nullptr};
 
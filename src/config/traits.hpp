@@ -24,6 +24,7 @@
 #ifndef TRAITS_HPP
 #define TRAITS_HPP
 
+#include <atomic>
 #include <iostream>
 #include <string>
 
@@ -46,6 +47,7 @@ template<> struct Traits<Debug>
     static const bool warning = false; /* Prints warnings.             */
     static const bool info    = true;  /* Prints relevant information. */
     static const bool trace   = true;  /* Prints function call trace.  */
+    static const int  level   = 4;     /* Runtime level at start: TRC. */
 };
 
 /*================================================================================*/
@@ -58,6 +60,25 @@ template<> struct Traits<control::MainControl> : public Traits<void>
 };
 
 template<> struct Traits<control::ObjectLoader> : public Traits<void>
+{
+    static const bool   mapped = true;      /* mmap OBJ files instead of reading them. */
+    static const bool   cached = true;      /* Keep a binary SceneCache next to them.  */
+    static const size_t chunk  = 4 << 20;   /* Bytes parsed per task.                  */
+    static const bool debugged = hysterically_debugged;
+};
+
+template<> struct Traits<control::Renderer> : public Traits<void>
+{
+    static const bool culling  = true; /* Skips shapes outside the window. */
+    static const bool debugged = hysterically_debugged;
+};
+
+template<> struct Traits<control::SceneCache> : public Traits<void>
+{
+    static const bool debugged = hysterically_debugged;
+};
+
+template<> struct Traits<control::Pipeline> : public Traits<void>
 {
     static const bool debugged = hysterically_debugged;
 };
@@ -74,7 +95,8 @@ template<> struct Traits<model::Vector> : public Traits<void>
 
 template<> struct Traits<model::Matrix> : public Traits<void>
 {
-    static const bool debugged = hysterically_debugged;
+    static const bool debugged   = hysterically_debugged;
+    static const bool vectorized = true; /* Enables SIMD batch kernels. */
 };
 
 template<> struct Traits<model::Shape> : public Traits<void>
@@ -119,9 +141,15 @@ template<> struct Traits<model::Window> : public Traits<void>
     static const bool has_perspective = true;                  /* Enables debug.    */
     
     static const double perspective_factor;              /* Enables debug.    */
+
+    /* Distances to the eye kept by clip_space::clip() */
+    static const double near_plane;
+    static const double far_plane;
 };
 
 const double Traits<model::Window>::perspective_factor = -1000;
+const double Traits<model::Window>::near_plane = 1;
+const double Traits<model::Window>::far_plane = 1e6;
 
 template<> struct Traits<model::Viewport> : public Traits<void>
 {
@@ -133,6 +161,72 @@ template<> struct Traits<model::ComplexShape> : public Traits<void>
     static const bool debugged = hysterically_debugged;
 };
 
+template<> struct Traits<model::VertexBuffer> : public Traits<void>
+{
+    static const bool debugged = hysterically_debugged;
+};
+
+template<> struct Traits<model::BVH> : public Traits<void>
+{
+    static const unsigned leaf = 8; /* Most shapes in a leaf. */
+    static const bool debugged = hysterically_debugged;
+};
+
+template<> struct Traits<model::Tessellation> : public Traits<void>
+{
+    static const double   tolerance;       /* Pixels a curve may stray from its segments. */
+    static const unsigned segments = 1024; /* Most segments of an adaptive cubic.        */
+    static const unsigned samples  = 100;  /* Segments of a cubic when uniform.          */
+    static const bool debugged = hysterically_debugged;
+};
+
+const double Traits<model::Tessellation>::tolerance = 0.25;
+
+template<> struct Traits<model::Frame> : public Traits<void>
+{
+    static const bool debugged = hysterically_debugged;
+};
+
+template<> struct Traits<model::Raster> : public Traits<void>
+{
+    static const int    tile = 64; /* Side in pixels of the tiles drawn in parallel.     */
+    static const double width;     /* Of the lines, in pixels (Cairo's default).         */
+    static const double bias;      /* Relative depth an outline may lie behind the fill. */
+    static const bool debugged = hysterically_debugged;
+};
+
+const double Traits<model::Raster>::width = 2.0;
+const double Traits<model::Raster>::bias = 1e-3;
+
+template<> struct Traits<sys::ThreadPool> : public Traits<void>
+{
+    static const unsigned threads = 0;  /* Pipeline threads (0: one per core).             */
+    static const unsigned callers = 4;  /* Outside threads with a queue of their own.      */
+    static const size_t   grain   = 64; /* Shapes per task in ComplexShape.                */
+    static const bool debugged = hysterically_debugged;
+};
+
+template<> struct Traits<sys::Statistics> : public Traits<void>
+{
+    static const bool     enabled = false; /* Times and counts pipeline stages.     */
+    static const bool     overlay = true;  /* Viewport draws them over each frame.  */
+    static const unsigned frames  = 120;   /* Frame times kept for the histogram.   */
+    static const std::string file;         /* Dumped to it when the GUI closes.     */
+    static const bool debugged = hysterically_debugged;
+};
+
+const std::string Traits<sys::Statistics>::file{"statistics.txt"};
+
+template<> struct Traits<sys::Trace> : public Traits<void>
+{
+    static const bool   enabled = false;   /* Records trace<T>() spans.           */
+    static const size_t events  = 1 << 16; /* Ring of events kept per thread.     */
+    static const std::string file;         /* Flushed to it when the GUI closes.  */
+    static const bool debugged = hysterically_debugged;
+};
+
+const std::string Traits<sys::Trace>::file{"trace.json"};
+
 /*================================================================================*/
 /*                             Auxiliar Definitions                               */
 /*================================================================================*/
@@ -188,44 +282,69 @@ const std::string Traits<sys::Color>::bold_white{"\033[1m\033[37m"};
 typedef std::basic_ostream<char, std::char_traits<char>> std_cout_type;
 typedef std_cout_type& (*std_endl_type)(std_cout_type&);
 
+enum Debug_Error   {ERR = 1};
+enum Debug_Warning {WRN = 2};
+enum Debug_Info    {INF = 3};
+enum Debug_Trace   {TRC = 4};
+
+/* Messages compiled in still print only up to the runtime level */
 class Debug
 {
 public:
+    Debug(int level, const std::string & color) : _active(level <= _level.load(std::memory_order_relaxed)) {
+        if (_active)
+            std::cout << color;
+    }
+
     template<typename T>
-    Debug & operator<<(const T & p) { std::cout << p; return *this; }
+    Debug & operator<<(const T & p) {
+        if (_active)
+            std::cout << p;
+        return *this;
+    }
 
     Debug & operator<<(std_endl_type m) {
-        m(std::cout);
-        std::cout << Traits<sys::Color>::reset;
+        if (_active) {
+            m(std::cout);
+            std::cout << Traits<sys::Color>::reset;
+        }
         return *this;
     }
-}; 
 
+    static int level() { return _level.load(std::memory_order_relaxed); }
+    static void level(int l) { _level.store(l, std::memory_order_relaxed); }
+
+private:
+    bool _active;
+
+    static std::atomic<int> _level;
+};
+
+std::atomic<int> Debug::_level{Traits<Debug>::level};
+
+/* Does nothing at all: every call inlines away. Stream arguments are still
+ * evaluated through db<>(), never through DB(), the one for hot paths. */
 class Null_Debug
 {
 public:
-    template<typename T>
-    Null_Debug & operator<<(const T & o) { return *this; }
+    Null_Debug(int, const std::string &) {}
 
     template<typename T>
-    Null_Debug & operator<<(const T * o) { return *this; }
+    Null_Debug & operator<<(const T &) { return *this; }
 
-    Null_Debug & operator<<(std_endl_type m)
-    {
-        std::cout << Traits<sys::Color>::reset;
-        return *this;
-    }
+    Null_Debug & operator<<(std_endl_type) { return *this; }
 };
 
 template<bool debugged>
-class Select_Debug: public Debug {};
+class Select_Debug: public Debug {
+public:
+    using Debug::Debug;
+};
 template<>
-class Select_Debug<false>: public Null_Debug {};
-
-enum Debug_Error   {ERR = 1};
-enum Debug_Warning {WRN = 2};
-enum Debug_Info    {INF = 3};
-enum Debug_Trace   {TRC = 4};
+class Select_Debug<false>: public Null_Debug {
+public:
+    using Null_Debug::Null_Debug;
+};
 
 /*--------------------------------------------------------------------------------*/
 /*                                     Error                                      */
@@ -235,16 +354,14 @@ template<typename T>
 inline Select_Debug<(Traits<T>::debugged && Traits<Debug>::error)> 
 db(Debug_Error l)
 {
-    Select_Debug<(Traits<T>::debugged && Traits<Debug>::error)>() << Traits<sys::Color>::red;
-    return Select_Debug<(Traits<T>::debugged && Traits<Debug>::error)>(); 
+    return Select_Debug<(Traits<T>::debugged && Traits<Debug>::error)>(l, Traits<sys::Color>::red);
 }
 
 template<typename T1, typename T2>
 inline Select_Debug<((Traits<T1>::debugged || Traits<T2>::debugged) && Traits<Debug>::error)> 
 db(Debug_Error l)
 {
-    Select_Debug<((Traits<T1>::debugged || Traits<T2>::debugged) && Traits<Debug>::error)>() << Traits<sys::Color>::red;
-    return Select_Debug<((Traits<T1>::debugged || Traits<T2>::debugged) && Traits<Debug>::error)>(); 
+    return Select_Debug<((Traits<T1>::debugged || Traits<T2>::debugged) && Traits<Debug>::error)>(l, Traits<sys::Color>::red);
 }
 
 /*--------------------------------------------------------------------------------*/
@@ -255,16 +372,14 @@ template<typename T>
 inline Select_Debug<(Traits<T>::debugged && Traits<Debug>::warning)> 
 db(Debug_Warning l)
 {
-    Select_Debug<(Traits<T>::debugged && Traits<Debug>::warning)>() << Traits<sys::Color>::yellow;
-    return Select_Debug<(Traits<T>::debugged && Traits<Debug>::warning)>(); 
+    return Select_Debug<(Traits<T>::debugged && Traits<Debug>::warning)>(l, Traits<sys::Color>::yellow);
 }
 
 template<typename T1, typename T2>
 inline Select_Debug<((Traits<T1>::debugged || Traits<T2>::debugged) && Traits<Debug>::warning)>
 db(Debug_Warning l)
 {
-    Select_Debug<((Traits<T1>::debugged || Traits<T2>::debugged) && Traits<Debug>::warning)>() << Traits<sys::Color>::yellow;
-    return Select_Debug<((Traits<T1>::debugged || Traits<T2>::debugged) && Traits<Debug>::warning)>();
+    return Select_Debug<((Traits<T1>::debugged || Traits<T2>::debugged) && Traits<Debug>::warning)>(l, Traits<sys::Color>::yellow);
 }
 
 /*--------------------------------------------------------------------------------*/
@@ -275,16 +390,14 @@ template<typename T>
 inline Select_Debug<(Traits<T>::debugged && Traits<Debug>::info)> 
 db(Debug_Info l)
 {
-    Select_Debug<(Traits<T>::debugged && Traits<Debug>::info)>() << Traits<sys::Color>::cyan;
-    return Select_Debug<(Traits<T>::debugged && Traits<Debug>::info)>(); 
+    return Select_Debug<(Traits<T>::debugged && Traits<Debug>::info)>(l, Traits<sys::Color>::cyan);
 }
 
 template<typename T1, typename T2>
 inline Select_Debug<((Traits<T1>::debugged || Traits<T2>::debugged) && Traits<Debug>::info)>
 db(Debug_Info l)
 {
-    Select_Debug<((Traits<T1>::debugged || Traits<T2>::debugged) && Traits<Debug>::info)>() << Traits<sys::Color>::cyan;
-    return Select_Debug<((Traits<T1>::debugged || Traits<T2>::debugged) && Traits<Debug>::info)>();
+    return Select_Debug<((Traits<T1>::debugged || Traits<T2>::debugged) && Traits<Debug>::info)>(l, Traits<sys::Color>::cyan);
 }
 
 /*--------------------------------------------------------------------------------*/
@@ -295,16 +408,30 @@ template<typename T>
 inline Select_Debug<(Traits<T>::debugged && Traits<Debug>::trace)> 
 db(Debug_Trace l)
 {
-    Select_Debug<(Traits<T>::debugged && Traits<Debug>::trace)>() << Traits<sys::Color>::white;
-    return Select_Debug<(Traits<T>::debugged && Traits<Debug>::trace)>(); 
+    return Select_Debug<(Traits<T>::debugged && Traits<Debug>::trace)>(l, Traits<sys::Color>::white);
 }
 
 template<typename T1, typename T2>
 inline Select_Debug<((Traits<T1>::debugged || Traits<T2>::debugged) && Traits<Debug>::trace)>
 db(Debug_Trace l)
 {
-    Select_Debug<((Traits<T1>::debugged || Traits<T2>::debugged) && Traits<Debug>::trace)>() << Traits<sys::Color>::white;
-    return Select_Debug<((Traits<T1>::debugged || Traits<T2>::debugged) && Traits<Debug>::trace)>();
+    return Select_Debug<((Traits<T1>::debugged || Traits<T2>::debugged) && Traits<Debug>::trace)>(l, Traits<sys::Color>::white);
 }
 
+/*--------------------------------------------------------------------------------*/
+/*                                    Guarded                                     */
+/*--------------------------------------------------------------------------------*/
+
+/* Whether the messages of a level are compiled in */
+constexpr bool db_compiled(Debug_Error)   { return Traits<Debug>::error; }
+constexpr bool db_compiled(Debug_Warning) { return Traits<Debug>::warning; }
+constexpr bool db_compiled(Debug_Info)    { return Traits<Debug>::info; }
+constexpr bool db_compiled(Debug_Trace)   { return Traits<Debug>::trace; }
+
+/* db<T>(l) that evaluates its stream arguments only when the message prints:
+ * not at all when T is not debugged or level l is compiled out, past one
+ * branch below the runtime level */
+#define DB(T, l) \
+    if (!Traits<T>::debugged || !db_compiled(l) || (l) > Debug::level()) {} else db<T>(l)
+
 #endif  // TRAITS_HPP
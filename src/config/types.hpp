@@ -30,6 +30,9 @@ class Debug;
 namespace sys
 {
     enum Color {CLR = 1};
+    class ThreadPool;
+    class Statistics;
+    class Trace;
 } //! namespace sys
 
 namespace gui
@@ -41,6 +44,9 @@ namespace control
 {
     class MainControl;
     class ObjectLoader;
+    class Pipeline;
+    class Renderer;
+    class SceneCache;
 } //! namespace control
 
 namespace model
@@ -57,6 +63,12 @@ namespace model
     class Window;
     class Viewport;
     class ComplexShape;
+    class VertexBuffer;
+    class Frame;
+    class Box;
+    class BVH;
+    class Tessellation;
+    class Raster;
 } //! namespace model
 
 namespace view
@@ -26,6 +26,8 @@
 
 /* External includes */
 #include <vector>
+#include <functional>
+#include <mutex>
 #include <unordered_map>
 #include <gtkmm.h>
 
@@ -41,7 +43,11 @@
 #include "../model/b_spline_surface.hpp"
 #include "../model/window.hpp"
 #include "../model/viewport.hpp"
+#include "../sys/thread_pool.hpp"
+#include "../sys/trace.hpp"
 #include "object_loader.hpp"
+#include "pipeline.hpp"
+#include "renderer.hpp"
 
 namespace control
 {
@@ -111,6 +117,9 @@ namespace control
 		MainControl(Glib::RefPtr<Gtk::Builder>& builder, std::string path_name = "undefined") :
 			_builder(builder)
 		{
+			if (Traits<sys::Trace>::enabled)
+				sys::Trace::instance().name_thread("gtk");
+
 			build_window();
 			build_viewport();
 			build_tree_views();
@@ -119,12 +128,22 @@ namespace control
 			build_numeric_entrys();
 			build_advanced_options();
 
+			_loaded.connect(sigc::mem_fun(*this, &MainControl::on_objects_loaded));
+
 			disable_unused_interface_objects(ButtonID::Null);
 		}
 
 		~MainControl()
 		{
+			delete _pipeline;
+			delete _renderer;
 			delete _viewport;
+
+			if (Traits<sys::Statistics>::enabled)
+				sys::Statistics::instance().dump(Traits<sys::Statistics>::file);
+
+			if (Traits<sys::Trace>::enabled)
+				sys::Trace::instance().flush(Traits<sys::Trace>::file);
 		}
 
 		/**
@@ -139,6 +158,8 @@ namespace control
 		void zoom_out();
 		void clockwise();
 		void counterclockwise();
+		void rotate(double direction);
+		void transform(const std::function<model::Matrix(const model::Shape *)> & matrix);
 		/**@}*/
 
 		/**
@@ -155,6 +176,8 @@ namespace control
 		void on_dialog_insert_clicked();
 		void on_dialog_delete_clicked();
 		void on_combo_line_clipp_changed();
+		void on_combo_backend_changed();
+		void on_check_back_faces_toggled();
 		void on_load_object();
 		void on_dialog_file_ok_clicked();
 		void on_dialog_file_cancel_clicked();
@@ -174,6 +197,7 @@ namespace control
 		void reset_dialog_entries();
 		void build_advanced_options();
 		void load_objects(std::string path_name);
+		void on_objects_loaded();
 		/**@}*/
 
 		/**
@@ -182,7 +206,7 @@ namespace control
 		/**@{*/
 		void enable_used_interface_objects(ButtonID selected);
 		void disable_unused_interface_objects(ButtonID selected);
-		void build_objects(std::vector<std::shared_ptr<model::Shape>> shapes);
+		void render(model::Frame & frame);
 		/**@}*/
 
 		/**
@@ -198,6 +222,7 @@ namespace control
 		void insert_object(std::string name, std::string type);
 		void insert_curve(std::string name, std::string type);
 		void insert_surface(std::string name, std::string type);
+		void insert_shape(std::shared_ptr<model::Shape> shape);
 		/**@}*/
 
 		/**
@@ -210,14 +235,21 @@ namespace control
 		int _objects_control{ 0};
 		int _vectors_control{ 0};
 
-		/* Model */
-		model::Window   *_window  {nullptr};
-		model::Viewport *_viewport{nullptr};
+		/* Model (_window and _shapes are only touched by pipeline jobs) */
+		model::Window     *_window  {nullptr};
+		model::Viewport   *_viewport{nullptr};
+		control::Pipeline *_pipeline{nullptr};
+		control::Renderer *_renderer{nullptr};
 
 		/* Shapes */
 		std::vector<std::shared_ptr<model::Shape>> _shapes;
 		std::unordered_map<int, std::shared_ptr<model::Shape>> _shapes_map;
 
+		/* Parsed by a pipeline job, listed and inserted by the GTK thread */
+		Glib::Dispatcher _loaded;
+		std::mutex _loaded_lock;
+		std::vector<std::shared_ptr<model::Shape>> _loaded_shapes;
+
 		/* Gtk */
 		Glib::RefPtr<Gtk::Builder> _builder;
 		ModelColumnsObjects _tree_model_objects;
@@ -246,18 +278,7 @@ namespace control
 
 		auto T = model::transformation::translation(model::Vector(0, step));
 
-		if (_shape_selected)
-		{
-			_shapes_map[_shape_selected]->transformation(T);
-			build_objects({_shapes_map[_shape_selected]});
-		}
-		else
-		{
-			_window->transformation(T);
-			build_objects(_shapes);
-		}
-
-		_viewport->update();
+		transform([T](const model::Shape *) { return T; });
 	}
 
 	void MainControl::left()
@@ -271,18 +292,7 @@ namespace control
 
 		auto T = model::transformation::translation(model::Vector(step, 0));
 
-		if (_shape_selected)
-		{
-			_shapes_map[_shape_selected]->transformation(T);
-			build_objects({_shapes_map[_shape_selected]});
-		}
-		else
-		{
-			_window->transformation(T);
-			build_objects(_shapes);
-		}
-
-		_viewport->update();
+		transform([T](const model::Shape *) { return T; });
 	}
 
 	void MainControl::right()
@@ -296,18 +306,7 @@ namespace control
 
 		auto T = model::transformation::translation(model::Vector(step, 0));
 
-		if (_shape_selected)
-		{
-			_shapes_map[_shape_selected]->transformation(T);
-			build_objects({_shapes_map[_shape_selected]});
-		}
-		else
-		{
-			_window->transformation(T);
-			build_objects(_shapes);
-		}
-
-		_viewport->update();
+		transform([T](const model::Shape *) { return T; });
 	}
 
 	void MainControl::down()
@@ -321,18 +320,7 @@ namespace control
 
 		auto T = model::transformation::translation(model::Vector(0, step));
 
-		if (_shape_selected)
-		{
-			_shapes_map[_shape_selected]->transformation(T);
-			build_objects({_shapes_map[_shape_selected]});
-		}
-		else
-		{
-			_window->transformation(T);
-			build_objects(_shapes);
-		}
-
-		_viewport->update();
+		transform([T](const model::Shape *) { return T; });
 	}
 
 	void MainControl::zoom_in()
@@ -343,22 +331,10 @@ namespace control
 		_builder->get_widget("spin_percentual", spin);
 
 		double times = spin->get_value();
-		auto mass_center = _shapes_map[_shape_selected]->mass_center();
-		
-		auto T = model::transformation::scaling(times, mass_center);
 
-		if (_shape_selected)
-		{
-			_shapes_map[_shape_selected]->transformation(T);
-			build_objects({_shapes_map[_shape_selected]});
-		}
-		else
-		{
-			_window->transformation(T);
-			build_objects(_shapes);
-		}
-
-		_viewport->update();
+		transform([times](const model::Shape * selected) {
+			return model::transformation::scaling(times, selected ? selected->mass_center() : model::Vector(0, 0));
+		});
 	}
 
 	void MainControl::zoom_out()
@@ -369,38 +345,38 @@ namespace control
 		_builder->get_widget("spin_percentual", spin);
 
 		double times = 1 / spin->get_value();
-		auto mass_center = _shapes_map[_shape_selected]->mass_center();
-
-		auto T = model::transformation::scaling(times, mass_center);
-
-		if (_shape_selected)
-		{
-			_shapes_map[_shape_selected]->transformation(T);
-			build_objects({_shapes_map[_shape_selected]});
-		}
-		else
-		{
-			_window->transformation(T);
-			build_objects(_shapes);
-		}
 
-		_viewport->update();
+		transform([times](const model::Shape * selected) {
+			return model::transformation::scaling(times, selected ? selected->mass_center() : model::Vector(0, 0));
+		});
 	}
 
 	void MainControl::clockwise()
 	{
 		db<MainControl>(TRC) << "MainControl::clockwise()" << std::endl;
 
+		rotate(_shape_selected ? 1 : -1);
+	}
+
+	void MainControl::counterclockwise()
+	{
+		db<MainControl>(TRC) << "MainControl::counterclockwise()" << std::endl;
+
+		rotate(_shape_selected ? -1 : 1);
+	}
+
+	void MainControl::rotate(double direction)
+	{
 		Gtk::Entry *entry;
 		Gtk::SpinButton *spin;
 		Gtk::RadioButton *radio;
 		Gtk::CheckButton *check;
-		model::Vector mass_center;
-		model::Vector normal;
+		model::Vector specific_center;
+		model::Vector specific_axis;
 
 		/* Calculate the angle */
 		_builder->get_widget("spin_degrees", spin);
-		double angle = (_shape_selected ? 1 : -1) * spin->get_value() * (M_PI / 180);
+		double angle = direction * spin->get_value() * (M_PI / 180);
 
 		/* Calculate the center of mass */
 		unsigned hash = 0;
@@ -417,13 +393,7 @@ namespace control
 		switch (hash)
 		{
 			case ButtonID::CenterObject:
-				mass_center = _shapes_map[_shape_selected]->mass_center();
-				normal = _shapes_map[_shape_selected]->normal();
-				break;
-
 			case ButtonID::CenterWorld:
-				mass_center = model::Vector(0, 0);
-				normal = model::Vector(0, 0, 1);
 				break;
 
 			case ButtonID::CenterSpecific: {
@@ -441,8 +411,7 @@ namespace control
 					z = atof(std::string(entry->get_text()).c_str());
 				}
 				
-				mass_center = model::Vector(x, y, z);
-				normal = _shapes_map[_shape_selected]->normal() - _shapes_map[_shape_selected]->mass_center() + mass_center;
+				specific_center = model::Vector(x, y, z);
 
 				break;
 			}
@@ -454,7 +423,9 @@ namespace control
 		
 		_builder->get_widget("check_specific_axis", check);
 
-		if (check->get_active())
+		bool has_specific_axis = check->get_active();
+
+		if (has_specific_axis)
 		{
 			double axis_x{0}, axis_y{0}, axis_z{model::Vector::z};
 			
@@ -470,127 +441,66 @@ namespace control
 				axis_z = atof(std::string(entry->get_text()).c_str());
 			}
 
-			normal = model::Vector(axis_x, axis_y, axis_z) + mass_center;
+			specific_axis = model::Vector(axis_x, axis_y, axis_z);
 		}
 
-		/* Calculate the rotation matrix */
-		auto T = model::transformation::rotation(angle, mass_center, normal);
+		/* Calculate the rotation matrix (selected shape is read by the pipeline) */
+		transform([=](const model::Shape * selected) {
+			/* The window turns around the center of the view */
+			const model::Vector center = selected ? selected->mass_center() : model::Vector(0, 0);
+			const model::Vector axis = selected ? selected->normal() : model::Vector(0, 0, 1);
+			model::Vector mass_center;
+			model::Vector normal;
 
-		if (_shape_selected)
-		{
-			_shapes_map[_shape_selected]->transformation(T);
-			build_objects({_shapes_map[_shape_selected]});
-		}
-		else
-		{
-			_window->transformation(T);
-			build_objects(_shapes);
-		}
+			switch (hash)
+			{
+				case ButtonID::CenterObject:
+					mass_center = center;
+					normal = axis;
+					break;
+
+				case ButtonID::CenterWorld:
+					mass_center = model::Vector(0, 0);
+					normal = model::Vector(0, 0, 1);
+					break;
+
+				default:
+					mass_center = specific_center;
+					normal = axis - center + mass_center;
+					break;
+			}
 
-		_viewport->update();
+			if (has_specific_axis)
+				normal = specific_axis + mass_center;
+
+			return model::transformation::rotation(angle, mass_center, normal);
+		});
 	}
 
-	void MainControl::counterclockwise()
+	void MainControl::transform(const std::function<model::Matrix(const model::Shape *)> & matrix)
 	{
-		db<MainControl>(TRC) << "MainControl::counterclockwise()" << std::endl;
+		/* The window (id 0) is handed to the matrix as null */
+		std::shared_ptr<model::Shape> selected;
 
-		Gtk::Entry *entry;
-		Gtk::SpinButton *spin;
-		Gtk::RadioButton *radio;
-		Gtk::CheckButton *check;
-		model::Vector mass_center;
-		model::Vector normal;
-
-		/* Calculate the angle */
-		_builder->get_widget("spin_degrees", spin);
-		double angle = (_shape_selected ? -1 : 1) * spin->get_value() * (M_PI / 180);
-
-		/* Calculate the center of mass */
-		unsigned hash = 0;
-
-		_builder->get_widget("radio_center_object", radio);
-		hash += radio->get_active() ? ButtonID::CenterObject     : ButtonID::Null;
-
-		_builder->get_widget("radio_center_world", radio);
-		hash += radio->get_active() ? ButtonID::CenterWorld      : ButtonID::Null;
-
-		_builder->get_widget("radio_center_specific", radio);
-		hash += radio->get_active() ? ButtonID::CenterSpecific : ButtonID::Null;
-
-		switch (hash)
+		if (_shape_selected)
 		{
-			case ButtonID::CenterObject:
-				mass_center = _shapes_map[_shape_selected]->mass_center();
-				normal = _shapes_map[_shape_selected]->normal();
-				break;
-
-			case ButtonID::CenterWorld:
-				mass_center = model::Vector(0, 0);
-				normal = model::Vector(0, 0, 1);
-				break;
-
-			case ButtonID::CenterSpecific: {
-				double x{0}, y{0}, z{model::Vector::z};
-
-				_builder->get_widget("entry_rotation_x", entry);
-				x = atof(std::string(entry->get_text()).c_str());
-
-				_builder->get_widget("entry_rotation_y", entry);
-				y = atof(std::string(entry->get_text()).c_str());
+			auto it = _shapes_map.find(_shape_selected);
 
-				if (model::Vector::dimension == 4)
-				{
-					_builder->get_widget("entry_rotation_z", entry);
-					z = atof(std::string(entry->get_text()).c_str());
-				}
-				
-				mass_center = model::Vector(x, y, z);
-				normal = _shapes_map[_shape_selected]->normal() - _shapes_map[_shape_selected]->mass_center() + mass_center;
-
-				break;
-			}
-
-			/* Undefined */
-			default:
+			if (it == _shapes_map.end())
 				return;
-		}
-		
-		_builder->get_widget("check_specific_axis", check);
-
-		if (check->get_active())
-		{
-			double axis_x{0}, axis_y{0}, axis_z{model::Vector::z};
-			
-			_builder->get_widget("entry_rotation_x_axis", entry);
-			axis_x = atof(std::string(entry->get_text()).c_str());
-
-			_builder->get_widget("entry_rotation_y_axis", entry);
-			axis_y = atof(std::string(entry->get_text()).c_str());
-
-			if (model::Vector::dimension == 4)
-			{
-				_builder->get_widget("entry_rotation_z_axis", entry);
-				axis_z = atof(std::string(entry->get_text()).c_str());
-			}
 
-			normal = model::Vector(axis_x, axis_y, axis_z) + mass_center;
+			selected = it->second;
 		}
 
-		/* Calculate the rotation matrix */
-		auto T = model::transformation::rotation(angle, mass_center, normal);
+		_pipeline->post([this, selected, matrix]() {
+			auto span = trace<MainControl>("MainControl::transform");
+			const auto T = matrix(selected.get());
 
-		if (_shape_selected)
-		{
-			_shapes_map[_shape_selected]->transformation(T);
-			build_objects({_shapes_map[_shape_selected]});
-		}
-		else
-		{
-			_window->transformation(T);
-			build_objects(_shapes);
-		}
-
-		_viewport->update();
+			if (selected)
+				selected->transformation(T);
+			else
+				_window->transformation(T);
+		});
 	}
 
 /*--------------------------------------------------------------------------------*/
@@ -627,10 +537,44 @@ namespace control
 
 		_builder->get_widget("combo_line_clipp", combo_box);
 
-		if (combo_box->get_active_text() == "Cohen Sutherland")
-			model::Line::clipping_method = model::Line::ClippingMethod::Cohen_Sutherland;
-		else
-			model::Line::clipping_method = model::Line::ClippingMethod::Liang_Barsky;
+		auto method = combo_box->get_active_text() == "Cohen Sutherland"
+			? model::Line::ClippingMethod::Cohen_Sutherland
+			: model::Line::ClippingMethod::Liang_Barsky;
+
+		_pipeline->post([method]() {
+			model::Line::clipping_method = method;
+		});
+	}
+
+	void MainControl::on_combo_backend_changed()
+	{
+		Gtk::ComboBoxText* combo_box;
+
+		_builder->get_widget("combo_backend", combo_box);
+
+		/* Read only by Viewport::paint, on this thread */
+		model::Backend::kind = combo_box->get_active_text() == "Raster"
+			? model::Backend::Kind::Raster
+			: model::Backend::Kind::Cairo;
+
+		_viewport->update();
+	}
+
+	void MainControl::on_check_back_faces_toggled()
+	{
+		Gtk::CheckButton* button;
+
+		_builder->get_widget("check_back_faces", button);
+
+		const bool culling = button->get_active();
+
+		_pipeline->post([this, culling]() {
+			model::Polygon::back_face_culling = culling;
+
+			/* Up to date shapes would keep their faces until moved: build them all again */
+			for (auto & shape : _shapes)
+				shape->invalidate();
+		});
 	}
 
 	void MainControl::on_new_object_clicked()
@@ -853,8 +797,6 @@ namespace control
 				break;
 		}
 
-		_viewport->update();
-
 		reset_dialog_entries();
 	}
 
@@ -887,20 +829,17 @@ namespace control
 		if(!_shape_selected)
 			return;
 
-		auto to_remove = std::find(
-			_shapes.begin(),
-			_shapes.end(),
-			_shapes_map[_shape_selected]
-		);
+		auto shape = _shapes_map[_shape_selected];
+
+		_pipeline->post([this, shape]() {
+			_shapes.erase(std::find(_shapes.begin(), _shapes.end(), shape));
+		});
 
-		_shapes.erase(to_remove);
 		_shapes_map.erase(_shape_selected);
 
 		erase_object_entry(_shape_selected);
 
 		_shape_selected = 0;
-
-		_viewport->update();
 	}
 
 	void MainControl::on_dialog_delete_clicked()
@@ -948,16 +887,36 @@ namespace control
 
 	void MainControl::load_objects(std::string path_name)
 	{
-		ObjectLoader loader;
+		/* Large models take a while: the GTK thread stays responsive */
+		_pipeline->post([this, path_name]() {
+			auto span = trace<MainControl>("MainControl::load_objects");
+
+			ObjectLoader loader;
 
-		auto new_shapes = loader.load(path_name, _window->min(), _window->max());
+			auto new_shapes = loader.load(path_name, _window->min(), _window->max());
 
-		_shapes.insert(_shapes.end(), new_shapes.begin(), new_shapes.end());
+			{
+				std::lock_guard<std::mutex> guard(_loaded_lock);
+				_loaded_shapes.insert(_loaded_shapes.end(), new_shapes.begin(), new_shapes.end());
+			}
+
+			_loaded.emit();
+		});
+	}
+
+	void MainControl::on_objects_loaded()
+	{
+		std::vector<std::shared_ptr<model::Shape>> new_shapes;
+
+		{
+			std::lock_guard<std::mutex> guard(_loaded_lock);
+			new_shapes.swap(_loaded_shapes);
+		}
 
 		for (auto & s : new_shapes)
 		{
-			_shapes_map[_objects_control] = s;
-			add_entry(_objects_control++, s->name(), s->type());
+			add_entry(_objects_control, s->name(), s->type());
+			insert_shape(s);
 		}
 	}
 
@@ -977,6 +936,7 @@ namespace control
 		height = alloc.get_height() / 2;
 
 		_window = new model::Window(model::Vector(-width, -height, 0), model::Vector(width, height, 0));
+		_renderer = new control::Renderer(*_window);
 
 		_shapes.emplace_back(&_window->drawable());
 		_shapes_map[_objects_control++] = _shapes.back();
@@ -1013,9 +973,11 @@ namespace control
 
 		Gtk::DrawingArea *draw;
 		_builder->get_widget("area_draw", draw);
-		_viewport = new model::Viewport(*_window, _shapes, *draw);
+		_viewport = new model::Viewport(*_window, *draw);
 
-		_viewport->update();
+		/* First frame: nothing to apply, just build what exists */
+		_pipeline = new control::Pipeline(*_viewport, [this](model::Frame & frame) { render(frame); });
+		_pipeline->post([]() {});
 	}
 
 	void MainControl::build_tree_views()
@@ -1197,6 +1159,20 @@ namespace control
 
 		combo_box->signal_changed().connect(sigc::mem_fun(*this, &MainControl::on_combo_line_clipp_changed));
 
+		_builder->get_widget("combo_backend", combo_box);
+
+		combo_box->append("Cairo");
+		combo_box->append("Raster");
+
+		combo_box->set_active_text("Cairo");
+
+		combo_box->signal_changed().connect(sigc::mem_fun(*this, &MainControl::on_combo_backend_changed));
+
+		Gtk::CheckButton* check;
+
+		_builder->get_widget("check_back_faces", check);
+		check->signal_clicked().connect(sigc::mem_fun(*this, &MainControl::on_check_back_faces_toggled));
+
 		_builder->get_widget("button_load_object", btn);
 		btn->signal_clicked().connect(sigc::mem_fun(*this, &MainControl::on_load_object));
 
@@ -1251,30 +1227,9 @@ namespace control
 /*                    Auxiliar object and interface modifications                 */
 /*--------------------------------------------------------------------------------*/
 
-	void MainControl::build_objects(std::vector<std::shared_ptr<model::Shape>> shapes)
+	void MainControl::render(model::Frame & frame)
 	{
-		static const model::Vector cmin{
-			model::Window::fixed_min[0] - 0.05 * model::Window::fixed_min[0],
-			model::Window::fixed_min[1] - 0.05 * model::Window::fixed_min[1]
-		};
-		static const model::Vector cmax{
-			model::Window::fixed_max[0] - 0.05 * model::Window::fixed_max[0],
-			model::Window::fixed_max[1] - 0.05 * model::Window::fixed_max[1]
-		};
-
-		const model::Matrix T = _window->transformation() * _window->normalization();
-
-		for (auto shape: shapes)
-			if (shape->name().compare("window"))
-			{
-				shape->w_transformation(T);
-
-				if (Traits<model::Window>::has_perspective)
-					shape->perspective();
-
-				if (Traits<model::Window>::need_clipping)
-					shape->clipping(cmin, cmax);
-			}
+		_renderer->render(_shapes, frame);
 	}
 
 	void MainControl::enable_used_interface_objects(ButtonID selected)
@@ -1663,10 +1618,7 @@ namespace control
 
 		add_entry(_objects_control, name, "Point");
 
-		_shapes.emplace_back(new model::Point(name, x, y, z));
-		_shapes_map[_objects_control++] = _shapes.back();
-
-		build_objects({_shapes.back()});
+		insert_shape(std::make_shared<model::Point>(name, x, y, z));
 	}
 
 	void MainControl::insert_object(std::string name, std::string type)
@@ -1700,18 +1652,14 @@ namespace control
 		add_entry(_objects_control, name, type);
 
 		if (!type.compare("Line"))
-			_shapes.emplace_back(new model::Line(name, model::Vector(x1, y1, z1), model::Vector(x2, y2, z2)));
+			insert_shape(std::make_shared<model::Line>(name, model::Vector(x1, y1, z1), model::Vector(x2, y2, z2)));
 		else
 		{
 			Gtk::CheckButton *button;
 			_builder->get_widget("check_filled", button);
 
-			_shapes.emplace_back(new model::Rectangle(name, model::Vector(x1, y1, z1), model::Vector(x2, y2, z2), button->get_active()));
+			insert_shape(std::make_shared<model::Rectangle>(name, model::Vector(x1, y1, z1), model::Vector(x2, y2, z2), button->get_active()));
 		}
-
-		_shapes_map[_objects_control++] = _shapes.back();
-
-		build_objects({_shapes.back()});
 	}
 
 	void MainControl::insert_polygon(std::string name)
@@ -1743,10 +1691,7 @@ namespace control
 		Gtk::CheckButton *button;
 		_builder->get_widget("check_filled", button);
 
-		_shapes.emplace_back(new model::Polygon(name, vectors, button->get_active()));
-		_shapes_map[_objects_control++] = _shapes.back();
-
-		build_objects({_shapes.back()});
+		insert_shape(std::make_shared<model::Polygon>(name, vectors, button->get_active()));
 	}
 
 	void MainControl::insert_curve(std::string name, std::string type)
@@ -1782,17 +1727,13 @@ namespace control
 				return;
 
 			add_entry(_objects_control, name, "Bezier Curve");
-			_shapes.emplace_back(new model::Bezier(name, vectors));
+			insert_shape(std::make_shared<model::Bezier>(name, vectors));
 		}
 		else
 		{
 			add_entry(_objects_control, name, "B-Spline Curve");
-			_shapes.emplace_back(new model::BSpline(name, vectors));
+			insert_shape(std::make_shared<model::BSpline>(name, vectors));
 		}
-
-		_shapes_map[_objects_control++] = _shapes.back();
-
-		build_objects({_shapes.back()});
 	}
 
 	void MainControl::insert_surface(std::string name, std::string type)
@@ -1841,17 +1782,22 @@ namespace control
 		if (!type.compare("Bezier Surface"))
 		{
 			add_entry(_objects_control, name, "Bezier Surface");
-			_shapes.emplace_back(new model::BezierSurface(name, v));
+			insert_shape(std::make_shared<model::BezierSurface>(name, v));
 		}
 		else
 		{
 			add_entry(_objects_control, name, "B-Spline Surface");
-			_shapes.emplace_back(new model::BSplineSurface(name, v));
+			insert_shape(std::make_shared<model::BSplineSurface>(name, v));
 		}
+	}
 
-		_shapes_map[_objects_control++] = _shapes.back();
+	void MainControl::insert_shape(std::shared_ptr<model::Shape> shape)
+	{
+		_shapes_map[_objects_control++] = shape;
 
-		build_objects({_shapes.back()});
+		_pipeline->post([this, shape]() {
+			_shapes.push_back(shape);
+		});
 	}
 
 	void MainControl::add_entry(int id, std::string name, std::string type)
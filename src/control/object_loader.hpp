@@ -25,13 +25,25 @@
 #define CONTROL_OBJECT_LOADER_HPP
 
 /* External includes */
-#include <fstream>
-#include <sstream>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
 
 /* Local includes */
 #include "../config/traits.hpp"
 #include "../model/complex_shape.hpp"
+#include "../model/line.hpp"
+#include "../model/point.hpp"
+#include "../model/polygon.hpp"
+#include "../model/vertex_buffer.hpp"
 #include "../model/window.hpp"
+#include "scene_cache.hpp"
+#include "../sys/mapped_file.hpp"
+#include "../sys/thread_pool.hpp"
+#include "../sys/trace.hpp"
 
 namespace control
 {
@@ -43,45 +55,216 @@ namespace control
 	class ObjectLoader
 	{
 	public:
-		ObjectLoader()  = default;
+		explicit ObjectLoader(sys::ThreadPool & pool = sys::ThreadPool::instance());
 		~ObjectLoader() = default;
 
+		//! Faces become filled polygons, solid under model::Raster. Skips the SceneCache.
+		static bool filled;
+
 		std::vector<std::shared_ptr<model::Shape>> load(std::string path_name, const model::Vector& min, const model::Vector& max);
-	
+
+		//! Parses OBJ text in [begin, end) without copying it, split in chunks (0: by Traits)
+		std::vector<std::shared_ptr<model::Shape>> parse(const char * begin, const char * end, size_t chunks = 0);
+
 	private:
-		std::vector<std::string> split(std::string s, const std::string & delimiter);
+		/* Non-owning view of a word inside the file */
+		struct Token
+		{
+			const char * begin{nullptr};
+			const char * end{nullptr};
+
+			bool operator==(const char * word) const;
+			std::string str() const;
+		};
+
+		/* An 'o', 'p', 'l' or 'f' line of a chunk */
+		struct Record
+		{
+			char type;
+			size_t first;    //!< First index in Chunk::indices (name in Chunk::names for 'o')
+			size_t size;     //!< Amount of indices
+			size_t vertices; //!< Chunk vertices read before it
+
+			/* Set by stitch() */
+			size_t slot;     //!< First shape it makes (npos: skipped)
+			size_t object;
+			int count;       //!< Number of its first shape inside the object
+		};
+
+		/* What a worker reads from its slice of the file. OBJ indices are global,
+		 * so they are kept as written and resolved by stitch(). */
+		struct Chunk
+		{
+			std::vector<model::Vector> vectors;
+			std::vector<Record> records;
+			std::vector<long> indices;
+			std::vector<std::string> names;
+		};
+
+		struct Object
+		{
+			std::string name;
+			std::shared_ptr<model::VertexBuffer> buffer;
+			size_t begin, end; //!< Its shape slots
+		};
+
+		static bool next(const char *& c, const char * end, Token & token);
+		static bool parse_double(const Token & token, double & value);
+		static bool parse_index(const Token & token, long & value);
+
+		static void parse_chunk(const char * begin, const char * end, Chunk & chunk);
+		std::vector<std::shared_ptr<model::Shape>> stitch(std::vector<Chunk> & chunks);
+
+		sys::ThreadPool & _pool;
 	};
 
 /*================================================================================*/
 /*                                 Implementaions                                 */
 /*================================================================================*/
 
+	bool ObjectLoader::Token::operator==(const char * word) const
+	{
+		size_t size = end - begin;
+		return std::strlen(word) == size && std::memcmp(begin, word, size) == 0;
+	}
+
+	std::string ObjectLoader::Token::str() const
+	{
+		return std::string(begin, end);
+	}
+
+	//! Moves c past the next word of the line [c, end)
+	bool ObjectLoader::next(const char *& c, const char * end, Token & token)
+	{
+		while (c < end && (*c == ' ' || *c == '\t' || *c == '\r'))
+			++c;
+
+		if (c == end)
+			return false;
+
+		token.begin = c;
+
+		while (c < end && *c != ' ' && *c != '\t' && *c != '\r')
+			++c;
 
-	std::vector<std::string> ObjectLoader::split(std::string s, const std::string & delimiter)
+		token.end = c;
+
+		return true;
+	}
+
+	/* Exact while the decimal mantissa and its power of ten fit a double
+	 * (one correctly rounded operation); anything else goes to strtod. */
+	bool ObjectLoader::parse_double(const Token & token, double & value)
 	{
-		size_t pos = 0;
-		std::string token;
-		std::vector<std::string> tokens;
-		
-		while ((pos = s.find(delimiter)) != std::string::npos)
+		static const double powers[] = {
+			1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+
+		const char * c = token.begin;
+		bool negative = false;
+
+		if (c < token.end && (*c == '-' || *c == '+'))
+			negative = *c++ == '-';
+
+		uint64_t mantissa = 0;
+		int digits = 0, exponent = 0;
+
+		for (; c < token.end && *c >= '0' && *c <= '9'; ++c, ++digits)
+			if (digits < 19)
+				mantissa = mantissa * 10 + (*c - '0');
+
+		if (c < token.end && *c == '.')
+			for (++c; c < token.end && *c >= '0' && *c <= '9'; ++c, ++digits, --exponent)
+				if (digits < 19)
+					mantissa = mantissa * 10 + (*c - '0');
+
+		if (digits && c < token.end && (*c == 'e' || *c == 'E'))
+		{
+			const char * e = c + 1;
+			bool e_negative = false;
+			int e_value = 0;
+
+			if (e < token.end && (*e == '-' || *e == '+'))
+				e_negative = *e++ == '-';
+
+			for (; e < token.end && *e >= '0' && *e <= '9' && e_value < 1000; ++e)
+				e_value = e_value * 10 + (*e - '0');
+
+			exponent += e_negative ? -e_value : e_value;
+			c = e;
+		}
+
+		if (digits && digits <= 19 && c == token.end
+		 && mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22)
 		{
-			token = s.substr(0, pos);
-			s.erase(0, pos + delimiter.length());
+			value = double(mantissa);
+			value = exponent < 0 ? value / powers[-exponent] : value * powers[exponent];
+			value = negative ? -value : value;
+			return true;
+		}
 
-			tokens.push_back(token);
+		/* Slow path: strtod needs a terminated copy */
+		char buffer[64];
+		std::string long_token;
+		const char * text = buffer;
+		size_t size = token.end - token.begin;
+
+		if (size < sizeof(buffer))
+		{
+			std::memcpy(buffer, token.begin, size);
+			buffer[size] = '\0';
 		}
+		else
+			text = (long_token = token.str()).c_str();
 
-		if(s.size())
-			tokens.push_back(s);
+		char * stop;
+		value = std::strtod(text, &stop);
 
-		return tokens;
+		return stop != text;
+	}
+
+	//! Vertex index of "v", "v/t", "v//n" or "v/t/n"
+	bool ObjectLoader::parse_index(const Token & token, long & value)
+	{
+		const char * c = token.begin;
+		bool negative = false;
+
+		if (c < token.end && *c == '-')
+			negative = *c++ == '-';
+
+		const char * digits = c;
+
+		for (value = 0; c < token.end && *c >= '0' && *c <= '9'; ++c)
+			value = value * 10 + (*c - '0');
+
+		value = negative ? -value : value;
+
+		return c != digits && (c == token.end || *c == '/');
+	}
+
+	bool ObjectLoader::filled{false};
+
+	ObjectLoader::ObjectLoader(sys::ThreadPool & pool) :
+		_pool(pool)
+	{
 	}
 
 	std::vector<std::shared_ptr<model::Shape>> ObjectLoader::load(std::string path_name, const model::Vector& min, const model::Vector& max)
 	{
 		db<ObjectLoader>(INF) << "ObjectLoader::load() => " << path_name << std::endl;
 
-		std::ifstream file(path_name);
+		auto span = trace<ObjectLoader>("ObjectLoader::load");
+
+		std::vector<std::shared_ptr<model::Shape>> shapes;
+		const std::string cache = SceneCache::path_of(path_name);
+
+		const bool cached = Traits<ObjectLoader>::cached && !filled;
+
+		if (cached && SceneCache::fresh(cache, path_name) && SceneCache::read(cache, shapes))
+			return shapes;
+
+		sys::MappedFile file(path_name, Traits<ObjectLoader>::mapped);
 
 		if (!file.is_open())
 		{
@@ -89,135 +272,265 @@ namespace control
 			return {};
 		}
 
-		auto map_x = [=](double x)
-		{
-			return x;
-			// return (x - model::Window::fixed_min[0])
-			// 	* (max[0] - min[0])
-			// 	/ (model::Window::fixed_max[0] - model::Window::fixed_min[0])
-			// 	+ min[0];
-		};
+		shapes = parse(file.data(), file.data() + file.size());
 
-		auto map_y = [=](double y)
-		{
-			return y;
-			// return (y - model::Window::fixed_min[1])
-			// 	* (max[1] - min[1])
-			// 	/ (model::Window::fixed_max[1] - model::Window::fixed_min[1])
-			// 	+ min[1];
-		};
+		if (cached)
+			SceneCache::write(cache, shapes);
+
+		return shapes;
+	}
 
-		auto map_z = [=](double z)
+	std::vector<std::shared_ptr<model::Shape>> ObjectLoader::parse(const char * begin, const char * end, size_t chunks)
+	{
+		if (!chunks)
+			chunks = std::max<size_t>(1, (end - begin) / Traits<ObjectLoader>::chunk);
+
+		//! Chunks start right after a newline
+		std::vector<const char *> bounds{begin};
+
+		for (size_t i = 1; i < chunks; ++i)
 		{
-			return z;
-			// return (z - model::Window::fixed_min[2])
-			// 	* (max[2] - min[2])
-			// 	/ (model::Window::fixed_max[2] - model::Window::fixed_min[2])
-			// 	+ min[2];
-		};
+			const char * c = std::max(bounds.back(), begin + (end - begin) * i / chunks);
+			const char * eol = static_cast<const char *>(std::memchr(c, '\n', end - c));
 
-		int count = 0;
-		std::string line;
-		std::string name;
+			bounds.push_back(eol ? eol + 1 : end);
+		}
 
-		std::vector<model::Vector> vectors;
-		std::vector<std::shared_ptr<model::Shape>> shapes;
-		std::vector<std::shared_ptr<model::Shape>> complex_shapes;
-		
-		while (std::getline(file, line))
+		bounds.push_back(end);
+
+		std::vector<Chunk> parsed(chunks);
+
+		_pool.parallel_for(0, chunks, 1, [&](size_t i) {
+			auto span = trace<ObjectLoader>("ObjectLoader::parse_chunk");
+			parse_chunk(bounds[i], bounds[i+1], parsed[i]);
+		});
+
+		return stitch(parsed);
+	}
+
+	void ObjectLoader::parse_chunk(const char * begin, const char * end, Chunk & chunk)
+	{
+		Token word;
+
+		for (const char * line = begin; line < end; )
 		{
-			std::vector<std::string> words = split(line, " ");
+			const char * eol = static_cast<const char *>(std::memchr(line, '\n', end - line));
+
+			if (!eol)
+				eol = end;
 
-			if (words.empty())
+			const char * c = line;
+			line = eol + (eol < end);
+
+			if (!next(c, eol, word))
 				continue;
 
-			switch (words[0][0])
+			if (word == "o")
 			{
-			case 'o':
-				if (!shapes.empty())
+				chunk.records.push_back({'o', chunk.names.size(), 0, chunk.vectors.size()});
+				chunk.names.push_back(next(c, eol, word) ? word.str() : "");
+			}
+			else if (word == "v")
+			{
+				double x, y, z;
+
+				if (!next(c, eol, word) || !parse_double(word, x)
+				 || !next(c, eol, word) || !parse_double(word, y)
+				 || !next(c, eol, word) || !parse_double(word, z))
 				{
-					complex_shapes.emplace_back(new model::ComplexShape(name, shapes));
-					shapes.clear();
+					db<ObjectLoader>(WRN) << "Malformed vertex skipped" << std::endl;
+					continue;
 				}
 
-				count = 0;
-				name = words[1];
-				break;
+				if (model::Vector::dimension == 3)
+					z = 1;
 
-			case 'v':
-				if (words[0] == "v")
+				chunk.vectors.emplace_back(x, y, z);
+			}
+			else if (word == "p" || word == "l" || word == "f")
+			{
+				Record record{*word.begin, chunk.indices.size(), 0, chunk.vectors.size()};
+
+				while (next(c, eol, word))
 				{
-					double x, y, z;
-
-					std::stringstream string_x(words[1]);
-					std::stringstream string_y(words[2]);
-					std::stringstream string_z(words[3]);
-
-					string_x >> x;
-					string_y >> y;
-					string_z >> z;
-
-					if (model::Vector::dimension == 3)
-						z = 1;
-					
-					vectors.emplace_back(
-						map_x(x),
-						map_y(y),
-						map_z(z)
-					);
+					long idx;
+
+					//! 0 is never a valid OBJ index: stitch() skips the record from there
+					if (!parse_index(word, idx))
+					{
+						chunk.indices.push_back(0);
+						break;
+					}
+
+					chunk.indices.push_back(idx);
 				}
 
-				break;
+				record.size = chunk.indices.size() - record.first;
+				chunk.records.push_back(record);
+			}
+		}
+	}
 
-			case 'p':
-			{
-				int p = std::stoi(split(words[1], "/")[0]) - 1;
+	std::vector<std::shared_ptr<model::Shape>> ObjectLoader::stitch(std::vector<Chunk> & chunks)
+	{
+		auto span = trace<ObjectLoader>("ObjectLoader::stitch");
 
-				shapes.emplace_back(
-					new model::Point(name + std::to_string(count++), vectors[p])
-				);
+		using Index = model::VertexBuffer::Index;
 
-				break;
-			}
+		const Index none = std::numeric_limits<Index>::max();
+		const size_t npos = std::numeric_limits<size_t>::max();
 
-			case 'l':
-			{
-				int p0 = std::stoi(split(words[1], "/")[0]) - 1;
-				int p1 = std::stoi(split(words[2], "/")[0]) - 1;
+		std::vector<model::Vector> vectors;
 
-				shapes.emplace_back(
-					new model::Line(name + std::to_string(count++), vectors[p0], vectors[p1])
-				);
+		size_t total = 0;
+		for (const auto & chunk : chunks)
+			total += chunk.vectors.size();
 
-				break;
-			}
+		vectors.reserve(total);
+		for (const auto & chunk : chunks)
+			vectors.insert(vectors.end(), chunk.vectors.begin(), chunk.vectors.end());
+
+		/* Vertices of the current object: OBJ index -> buffer index */
+		std::vector<Index> remap(total, none);
+		std::vector<size_t> used;
+
+		std::vector<Object> objects;
+		Object current{"", std::make_shared<model::VertexBuffer>(), 0, 0};
+
+		size_t slots = 0;
+		int count = 0;
+
+		auto close_object = [&]()
+		{
+			if (slots == current.begin)
+				return;
 
-			case 'f':
+			current.end = slots;
+			objects.push_back(current);
+
+			current.buffer = std::make_shared<model::VertexBuffer>();
+			current.begin = slots;
+
+			for (auto idx : used)
+				remap[idx] = none;
+
+			used.clear();
+		};
+
+		/* In file order: buffer indices depend on first use */
+		size_t offset = 0;
+
+		for (auto & chunk : chunks)
+		{
+			for (auto & record : chunk.records)
 			{
-				words.erase(words.begin());
-				std::vector<model::Vector> pvectors;
+				record.slot = npos;
 
-				for (const auto & v : words)
+				if (record.type == 'o')
 				{
-					int idx = std::stoi(split(v, "/")[0]) - 1;
-					pvectors.push_back(vectors[idx]);
+					close_object();
+
+					count = 0;
+					current.name = chunk.names[record.first];
+					continue;
 				}
 
-				shapes.emplace_back(
-					new model::Polygon(name + std::to_string(count++), pvectors)
-				);
+				//! OBJ indices start at 1, negative ones count back from the last vertex
+				const long available = offset + record.vertices;
+				bool valid = record.size >= (record.type == 'l' ? 2u : 1u);
 
-				break;
-			}
+				for (size_t i = record.first; valid && i < record.first + record.size; ++i)
+				{
+					long & idx = chunk.indices[i];
+
+					idx = idx < 0 ? available + idx : idx - 1;
+					valid = idx >= 0 && idx < available;
+				}
+
+				//! Checked whole before remapping: a skipped element adds no vertex
+				if (!valid)
+				{
+					db<ObjectLoader>(WRN) << "Malformed element skipped" << std::endl;
+					continue;
+				}
+
+				for (size_t i = record.first; i < record.first + record.size; ++i)
+				{
+					long & idx = chunk.indices[i];
+
+					if (remap[idx] == none)
+					{
+						remap[idx] = current.buffer->add(vectors[idx]);
+						used.push_back(idx);
+					}
 
-			default:
-				break;
+					idx = remap[idx];
+				}
+
+				//! "p" and "l" may list several points / a polyline
+				size_t made = record.type == 'p' ? record.size : record.type == 'l' ? record.size - 1 : 1;
+
+				record.slot   = slots;
+				record.object = objects.size();
+				record.count  = count;
+
+				slots += made;
+				count += made;
 			}
+
+			offset += chunk.vectors.size();
 		}
 
-		file.close();
+		//! Last object has no following 'o' to close it
+		close_object();
+
+		/* Shapes only need their own record now */
+		std::vector<std::shared_ptr<model::Shape>> shapes(slots);
+
+		_pool.parallel_for(0, chunks.size(), 1, [&](size_t c) {
+			auto span = trace<ObjectLoader>("ObjectLoader::build_shapes");
+			const auto & chunk = chunks[c];
+
+			for (const auto & record : chunk.records)
+			{
+				if (record.slot == npos)
+					continue;
+
+				const auto & object = objects[record.object];
+				const long * indices = &chunk.indices[record.first];
+
+				auto name = [&](size_t i) {
+					return object.name + std::to_string(record.count + i);
+				};
+
+				switch (record.type)
+				{
+				case 'p':
+					for (size_t i = 0; i < record.size; ++i)
+						shapes[record.slot + i].reset(new model::Point(name(i), object.buffer, indices[i]));
+					break;
+
+				case 'l':
+					for (size_t i = 1; i < record.size; ++i)
+						shapes[record.slot + i - 1].reset(new model::Line(name(i - 1), object.buffer, indices[i-1], indices[i]));
+					break;
+
+				default:
+					shapes[record.slot].reset(new model::Polygon(name(0), object.buffer,
+						std::vector<Index>(indices, indices + record.size), filled));
+					break;
+				}
+			}
+		});
+
+		std::vector<std::shared_ptr<model::Shape>> complex_shapes;
+
+		for (const auto & object : objects)
+			complex_shapes.emplace_back(new model::ComplexShape(object.name,
+				std::vector<std::shared_ptr<model::Shape>>(shapes.begin() + object.begin, shapes.begin() + object.end),
+				object.buffer));
 
-		return std::move(complex_shapes);
+		return complex_shapes;
 	}
 
 } //! namespace control
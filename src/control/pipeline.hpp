@@ -0,0 +1,159 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONTROL_PIPELINE_HPP
+#define CONTROL_PIPELINE_HPP
+
+/* External includes */
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Local includes */
+#include "../config/traits.hpp"
+#include "../model/frame.hpp"
+#include "../model/viewport.hpp"
+#include "../sys/statistics.hpp"
+#include "../sys/trace.hpp"
+
+namespace control
+{
+
+/*================================================================================*/
+/*                                   Definitions                                  */
+/*================================================================================*/
+
+	/* Worker thread that owns the model: applies changes, builds and presents frames */
+	class Pipeline
+	{
+	public:
+		using Job = std::function<void()>;
+		using Render = std::function<void(model::Frame &)>;
+
+		Pipeline(model::Viewport & viewport, const Render & render) :
+			_viewport(viewport),
+			_render(render),
+			_worker(&Pipeline::run, this)
+		{
+		}
+
+		~Pipeline();
+
+		/* Jobs posted while a frame is in flight are all applied before the next one */
+		void post(Job job);
+
+	private:
+		void run();
+
+		model::Viewport & _viewport;
+		Render _render;
+
+		std::vector<Job> _jobs;
+		std::mutex _lock;
+		std::condition_variable _wake;
+		bool _stop{false};
+
+		std::thread _worker; //!< Last: starts once everything else is built
+	};
+
+/*================================================================================*/
+/*                                 Implementaions                                 */
+/*================================================================================*/
+
+	Pipeline::~Pipeline()
+	{
+		{
+			std::lock_guard<std::mutex> guard(_lock);
+			_stop = true;
+		}
+
+		_wake.notify_one();
+		_worker.join();
+	}
+
+	void Pipeline::post(Job job)
+	{
+		{
+			std::lock_guard<std::mutex> guard(_lock);
+			_jobs.push_back(std::move(job));
+		}
+
+		_wake.notify_one();
+	}
+
+	void Pipeline::run()
+	{
+		if (Traits<sys::Trace>::enabled)
+			sys::Trace::instance().name_thread("pipeline");
+
+		std::vector<Job> jobs;
+		std::shared_ptr<model::Frame> back = std::make_shared<model::Frame>();
+
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> guard(_lock);
+				_wake.wait(guard, [this]() { return _stop || !_jobs.empty(); });
+
+				if (_stop)
+					return;
+
+				jobs.swap(_jobs);
+			}
+
+			DB(Pipeline, INF) << "Pipeline: " << jobs.size() << " coalesced jobs" << std::endl;
+
+			{
+				sys::Timer timer(sys::Statistics::FRAME);
+				auto span = trace<Pipeline>("Pipeline::frame");
+
+				{
+					auto span = trace<Pipeline>("Pipeline::jobs");
+
+					for (auto & job : jobs)
+						job();
+				}
+
+				jobs.clear();
+
+				back->clear();
+				_render(*back);
+			}
+
+			if (Traits<sys::Statistics>::enabled)
+				sys::Statistics::instance().close_frame();
+
+			/* Reuse the replaced frame unless on_draw still holds it */
+			back = _viewport.present(back);
+
+			if (back.use_count() > 1)
+				back = std::make_shared<model::Frame>();
+		}
+	}
+
+} //! namespace control
+
+#endif  // CONTROL_PIPELINE_HPP
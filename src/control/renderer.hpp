@@ -0,0 +1,198 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONTROL_RENDERER_HPP
+#define CONTROL_RENDERER_HPP
+
+/* External includes */
+#include <memory>
+#include <vector>
+
+/* Local includes */
+#include "../config/traits.hpp"
+#include "../model/frame.hpp"
+#include "../model/geometry.hpp"
+#include "../model/shape.hpp"
+#include "../model/tessellation.hpp"
+#include "../model/window.hpp"
+#include "../sys/statistics.hpp"
+#include "../sys/thread_pool.hpp"
+#include "../sys/trace.hpp"
+
+namespace control
+{
+
+/*================================================================================*/
+/*                                   Definitions                                  */
+/*================================================================================*/
+
+	/* Window -> normalization -> perspective (clip space, then the divide) ->
+	 * clipping of a scene, recorded into a Frame. Knows nothing about GTK:
+	 * the GUI and headless tools share it. */
+	class Renderer
+	{
+	public:
+		explicit Renderer(model::Window & window) :
+			_window(window)
+		{
+			//! The window is built as large as the drawing area, in pixels
+			model::Tessellation::viewport(_window.width(), _window.height());
+		}
+
+		~Renderer() = default;
+
+		/* Builds the window vectors of outdated shapes */
+		void build(const std::vector<std::shared_ptr<model::Shape>> & shapes);
+
+		/* Builds, then records every shape into frame */
+		void render(const std::vector<std::shared_ptr<model::Shape>> & shapes, model::Frame & frame);
+
+	private:
+		model::Window & _window;
+
+		/* Window transformation cache, rebuilt when the window version changes */
+		model::Matrix _window_T;
+		unsigned long _window_version{~0ul};
+	};
+
+/*================================================================================*/
+/*                                 Implementaions                                 */
+/*================================================================================*/
+
+	void Renderer::build(const std::vector<std::shared_ptr<model::Shape>> & shapes)
+	{
+		static const model::Vector cmin{
+			model::Window::fixed_min[0] - 0.05 * model::Window::fixed_min[0],
+			model::Window::fixed_min[1] - 0.05 * model::Window::fixed_min[1]
+		};
+		static const model::Vector cmax{
+			model::Window::fixed_max[0] - 0.05 * model::Window::fixed_max[0],
+			model::Window::fixed_max[1] - 0.05 * model::Window::fixed_max[1]
+		};
+
+		const unsigned long version = _window.version();
+
+		if (version != _window_version)
+		{
+			_window_T = _window.transformation() * _window.normalization();
+			_window_version = version;
+		}
+
+		/* Only shapes moved since their last build, or built for an older window */
+		std::vector<model::Shape *> outdated;
+
+		for (auto & shape: shapes)
+			if (shape->name().compare("window") && shape->outdated(version))
+				outdated.push_back(shape.get());
+
+		if (Traits<sys::Statistics>::enabled)
+			sys::Statistics::instance().add(sys::Statistics::SHAPES_BUILT, outdated.size());
+
+		const model::ViewVolume view(_window_T, cmin, cmax);
+
+		/* Each shape only writes its own window vectors: one task per shape */
+		sys::ThreadPool::instance().parallel_for(0, outdated.size(), 1, [&](size_t i) {
+			model::Shape * shape = outdated[i];
+
+			if (Traits<Renderer>::culling)
+			{
+				auto span = trace<Renderer>("Shape::cull");
+
+				//! Nothing to transform: the shape stays culled until rebuilt
+				if (shape->cull(view))
+				{
+					shape->built(version);
+					return;
+				}
+			}
+
+			if (Traits<sys::Statistics>::enabled)
+				sys::Statistics::instance().add(sys::Statistics::VERTICES_IN, shape->vertices());
+
+			{
+				sys::Timer timer(sys::Statistics::W_TRANSFORMATION);
+				auto span = trace<Renderer>("Shape::w_transformation");
+				shape->w_transformation(_window_T);
+			}
+
+			if (Traits<model::Window>::has_perspective)
+			{
+				sys::Timer timer(sys::Statistics::PERSPECTIVE);
+				auto span = trace<Renderer>("Shape::perspective");
+				shape->perspective();
+			}
+
+			//! Nothing in front of the eye: skips clipping as well
+			if (shape->culled())
+			{
+				shape->built(version);
+				return;
+			}
+
+			{
+				auto span = trace<Renderer>("Shape::facing");
+				shape->facing();
+			}
+
+			if (Traits<model::Window>::need_clipping)
+			{
+				sys::Timer timer(sys::Statistics::CLIPPING);
+				auto span = trace<Renderer>("Shape::clipping");
+				shape->clipping(cmin, cmax);
+			}
+
+			shape->built(version);
+		});
+	}
+
+	void Renderer::render(const std::vector<std::shared_ptr<model::Shape>> & shapes, model::Frame & frame)
+	{
+		build(shapes);
+
+		sys::Timer timer(sys::Statistics::RECORD);
+		auto span = trace<Renderer>("Renderer::record");
+
+		for (auto & shape : shapes)
+		{
+			const size_t points = frame.points();
+
+			if (!shape->culled())
+			{
+				shape->draw(frame);
+				frame.stroke();
+			}
+
+			if (Traits<sys::Statistics>::enabled && frame.points() == points)
+				sys::Statistics::instance().add(sys::Statistics::SHAPES_CULLED, 1);
+		}
+
+		if (Traits<sys::Statistics>::enabled)
+		{
+			sys::Statistics::instance().add(sys::Statistics::VERTICES_OUT, frame.points());
+			sys::Statistics::instance().add(sys::Statistics::SEGMENTS, frame.segments());
+		}
+	}
+
+} //! namespace control
+
+#endif  // CONTROL_RENDERER_HPP
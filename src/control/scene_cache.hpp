@@ -0,0 +1,413 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONTROL_SCENE_CACHE_HPP
+#define CONTROL_SCENE_CACHE_HPP
+
+/* External includes */
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+/* Local includes */
+#include "../config/traits.hpp"
+#include "../model/complex_shape.hpp"
+#include "../model/line.hpp"
+#include "../model/point.hpp"
+#include "../model/polygon.hpp"
+#include "../model/vertex_buffer.hpp"
+#include "../sys/mapped_file.hpp"
+#include "../sys/thread_pool.hpp"
+#include "../sys/trace.hpp"
+
+namespace control
+{
+
+/*================================================================================*/
+/*                                   Definitions                                  */
+/*================================================================================*/
+
+	/* Binary image of what ObjectLoader builds: one vertex block, index lists,
+	 * shape kinds and names per object. Every section is 8 byte aligned so the
+	 * mapped file is read in place. */
+	class SceneCache
+	{
+	public:
+		static const uint32_t version = 1;
+
+		/* Cache of an OBJ file: path.cache */
+		static std::string path_of(const std::string & source);
+
+		/* Is the cache newer than its source? */
+		static bool fresh(const std::string & path, const std::string & source);
+
+		static bool write(const std::string & path, const std::vector<std::shared_ptr<model::Shape>> & shapes);
+		static bool read(const std::string & path, std::vector<std::shared_ptr<model::Shape>> & shapes);
+
+		static uint64_t checksum(const char * data, size_t size);
+
+	private:
+		enum Kind : uint32_t {POINT, LINE, POLYGON, FILLED_POLYGON};
+
+		struct Header
+		{
+			char magic[8];
+			uint32_t version;
+			uint32_t order;     //!< 0x01020304 as written, catches foreign byte order
+			uint32_t dimension;
+			uint32_t reserved;
+			uint64_t objects;
+			uint64_t size;      //!< Bytes after the header
+			uint64_t checksum;  //!< Of those bytes
+		};
+
+		struct Sizes
+		{
+			uint64_t name;
+			uint64_t vertices;
+			uint64_t shapes;
+			uint64_t indices;
+			uint64_t names;     //!< Characters of all shape names
+		};
+
+		/* Bounds checked walk over the mapped payload */
+		class Reader
+		{
+		public:
+			Reader(const char * begin, const char * end);
+
+			template<typename T>
+			const T * take(size_t n);
+
+		private:
+			const char * _c;
+			const char * _end;
+		};
+
+		static void put(std::string & out, const void * data, size_t size);
+
+		static const char magic[8];
+		static const uint32_t order = 0x01020304;
+	};
+
+/*================================================================================*/
+/*                                 Implementaions                                 */
+/*================================================================================*/
+
+	const char SceneCache::magic[8] = {'C', 'G', 'S', 'C', 'E', 'N', 'E', '\0'};
+
+	SceneCache::Reader::Reader(const char * begin, const char * end) :
+		_c(begin),
+		_end(end)
+	{
+	}
+
+	//! n elements of T, or null when the payload is too short
+	template<typename T>
+	const T * SceneCache::Reader::take(size_t n)
+	{
+		const size_t size = n * sizeof(T);
+
+		if (n > size_t(_end - _c) / sizeof(T))
+			return nullptr;
+
+		const T * data = reinterpret_cast<const T *>(_c);
+		_c += std::min(size_t(_end - _c), (size + 7) & ~size_t(7));
+
+		return data;
+	}
+
+	void SceneCache::put(std::string & out, const void * data, size_t size)
+	{
+		out.append(static_cast<const char *>(data), size);
+		out.append((8 - size % 8) % 8, '\0');
+	}
+
+	std::string SceneCache::path_of(const std::string & source)
+	{
+		return source + ".cache";
+	}
+
+	bool SceneCache::fresh(const std::string & path, const std::string & source)
+	{
+		struct stat cache, obj;
+
+		if (::stat(path.c_str(), &cache) || ::stat(source.c_str(), &obj))
+			return false;
+
+		if (cache.st_mtim.tv_sec != obj.st_mtim.tv_sec)
+			return cache.st_mtim.tv_sec > obj.st_mtim.tv_sec;
+
+		return cache.st_mtim.tv_nsec > obj.st_mtim.tv_nsec;
+	}
+
+	/* Four independent lanes so it runs near memory speed */
+	uint64_t SceneCache::checksum(const char * data, size_t size)
+	{
+		const uint64_t prime = 0x100000001b3ull;
+		uint64_t lanes[4] = {0xcbf29ce484222325ull, 0x84222325cbf29ce4ull, 0x9ce4cbf284222325ull, 0x2325cbf29ce48422ull};
+
+		size_t i = 0;
+
+		for (; i + 32 <= size; i += 32)
+			for (int l = 0; l < 4; ++l)
+			{
+				uint64_t word;
+				std::memcpy(&word, data + i + 8 * l, 8);
+
+				lanes[l] = (lanes[l] ^ word) * prime;
+				lanes[l] ^= lanes[l] >> 29;
+			}
+
+		for (; i < size; ++i)
+			lanes[0] = (lanes[0] ^ uint8_t(data[i])) * prime;
+
+		uint64_t hash = size;
+
+		for (auto lane : lanes)
+			hash = (hash ^ lane) * prime;
+
+		return hash ^ (hash >> 32);
+	}
+
+	bool SceneCache::write(const std::string & path, const std::vector<std::shared_ptr<model::Shape>> & shapes)
+	{
+		db<SceneCache>(TRC) << "SceneCache::write() => " << path << std::endl;
+
+		auto span = trace<SceneCache>("SceneCache::write");
+
+		std::string payload;
+
+		for (const auto & shape : shapes)
+		{
+			auto object = std::dynamic_pointer_cast<model::ComplexShape>(shape);
+
+			if (!object || !object->buffer())
+			{
+				db<SceneCache>(WRN) << "Only loaded objects can be cached" << std::endl;
+				return false;
+			}
+
+			const auto & buffer = *object->buffer();
+			const auto & children = object->shapes();
+			const std::string name = object->name();
+
+			std::vector<uint32_t> kinds, counts, lengths;
+			std::vector<model::VertexBuffer::Index> indices;
+			std::string names;
+
+			for (const auto & child : children)
+			{
+				const std::string type = child->type();
+				auto polygon = std::dynamic_pointer_cast<model::Polygon>(child);
+
+				if (child->buffer() != object->buffer())
+				{
+					db<SceneCache>(WRN) << "Only loaded objects can be cached" << std::endl;
+					return false;
+				}
+
+				if (type == "Point")
+					kinds.push_back(POINT);
+				else if (type == "Line")
+					kinds.push_back(LINE);
+				else if (type == "Polygon")
+					kinds.push_back(polygon->filled() ? FILLED_POLYGON : POLYGON);
+				else
+				{
+					db<SceneCache>(WRN) << "Can not cache a " << type << std::endl;
+					return false;
+				}
+
+				const std::string child_name = child->name();
+
+				counts.push_back(child->indices().size());
+				indices.insert(indices.end(), child->indices().begin(), child->indices().end());
+				lengths.push_back(child_name.size());
+				names += child_name;
+			}
+
+			Sizes sizes{name.size(), buffer.size(), children.size(), indices.size(), names.size()};
+
+			put(payload, &sizes, sizeof(sizes));
+			put(payload, name.data(), name.size());
+
+			for (int c = 0; c < model::Vector::dimension; ++c)
+				put(payload, buffer.coordinates(c), buffer.size() * sizeof(double));
+
+			put(payload, kinds.data(), kinds.size() * sizeof(uint32_t));
+			put(payload, counts.data(), counts.size() * sizeof(uint32_t));
+			put(payload, indices.data(), indices.size() * sizeof(model::VertexBuffer::Index));
+			put(payload, lengths.data(), lengths.size() * sizeof(uint32_t));
+			put(payload, names.data(), names.size());
+		}
+
+		Header header{{}, version, order, model::Vector::dimension, 0,
+		              shapes.size(), payload.size(), checksum(payload.data(), payload.size())};
+		std::memcpy(header.magic, magic, sizeof(magic));
+
+		//! Written aside and renamed: readers never see half a cache
+		const std::string temporary = path + ".tmp";
+
+		{
+			std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+
+			file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+			file.write(payload.data(), payload.size());
+
+			if (!file)
+			{
+				db<SceneCache>(WRN) << "Unable to write " << temporary << std::endl;
+				std::remove(temporary.c_str());
+				return false;
+			}
+		}
+
+		return std::rename(temporary.c_str(), path.c_str()) == 0;
+	}
+
+	bool SceneCache::read(const std::string & path, std::vector<std::shared_ptr<model::Shape>> & shapes)
+	{
+		db<SceneCache>(TRC) << "SceneCache::read() => " << path << std::endl;
+
+		auto span = trace<SceneCache>("SceneCache::read");
+
+		using Index = model::VertexBuffer::Index;
+
+		sys::MappedFile file(path);
+
+		if (!file.is_open() || file.size() < sizeof(Header))
+			return false;
+
+		Header header;
+		std::memcpy(&header, file.data(), sizeof(header));
+
+		if (std::memcmp(header.magic, magic, sizeof(magic)) || header.version != version
+		 || header.order != order || header.dimension != model::Vector::dimension
+		 || header.size != file.size() - sizeof(Header))
+		{
+			db<SceneCache>(WRN) << "Incompatible cache " << path << std::endl;
+			return false;
+		}
+
+		const char * payload = file.data() + sizeof(Header);
+
+		if (checksum(payload, header.size) != header.checksum)
+		{
+			db<SceneCache>(WRN) << "Corrupted cache " << path << std::endl;
+			return false;
+		}
+
+		Reader reader(payload, payload + header.size);
+		std::vector<std::shared_ptr<model::Shape>> objects;
+
+		for (uint64_t o = 0; o < header.objects; ++o)
+		{
+			const Sizes * sizes = reader.take<Sizes>(1);
+
+			if (!sizes)
+				return false;
+
+			const char * name = reader.take<char>(sizes->name);
+			const double * world[model::Vector::dimension];
+
+			for (int c = 0; c < model::Vector::dimension; ++c)
+				world[c] = reader.take<double>(sizes->vertices);
+
+			const uint32_t * kinds   = reader.take<uint32_t>(sizes->shapes);
+			const uint32_t * counts  = reader.take<uint32_t>(sizes->shapes);
+			const Index    * indices = reader.take<Index>(sizes->indices);
+			const uint32_t * lengths = reader.take<uint32_t>(sizes->shapes);
+			const char     * names   = reader.take<char>(sizes->names);
+
+			if (!name || !world[model::Vector::dimension - 1] || !kinds || !counts || !indices || !lengths || !names)
+				return false;
+
+			/* Where each shape starts, checked before anything is built */
+			std::vector<uint64_t> first(sizes->shapes + 1, 0), name_first(sizes->shapes + 1, 0);
+
+			for (uint64_t s = 0; s < sizes->shapes; ++s)
+			{
+				first[s + 1] = first[s] + counts[s];
+				name_first[s + 1] = name_first[s] + lengths[s];
+			}
+
+			if (first.back() != sizes->indices || name_first.back() != sizes->names)
+				return false;
+
+			for (uint64_t i = 0; i < sizes->indices; ++i)
+				if (indices[i] >= sizes->vertices)
+					return false;
+
+			auto buffer = std::make_shared<model::VertexBuffer>();
+			buffer->assign(world, sizes->vertices);
+
+			std::vector<std::shared_ptr<model::Shape>> children(sizes->shapes);
+			std::atomic<bool> valid{true};
+
+			sys::ThreadPool::instance().parallel_for(0, sizes->shapes, Traits<sys::ThreadPool>::grain, [&](size_t s) {
+				std::string child_name(names + name_first[s], lengths[s]);
+				std::vector<Index> child_indices(indices + first[s], indices + first[s + 1]);
+
+				switch (kinds[s])
+				{
+				case POINT:
+					if (child_indices.size() == 1)
+						children[s].reset(new model::Point(child_name, buffer, child_indices[0]));
+					break;
+
+				case LINE:
+					if (child_indices.size() == 2)
+						children[s].reset(new model::Line(child_name, buffer, child_indices[0], child_indices[1]));
+					break;
+
+				case POLYGON:
+				case FILLED_POLYGON:
+					children[s].reset(new model::Polygon(child_name, buffer, child_indices, kinds[s] == FILLED_POLYGON));
+					break;
+				}
+
+				if (!children[s])
+					valid = false;
+			});
+
+			if (!valid)
+				return false;
+
+			objects.emplace_back(new model::ComplexShape(std::string(name, sizes->name), children, buffer));
+		}
+
+		shapes = std::move(objects);
+
+		return true;
+	}
+
+} //! namespace control
+
+#endif  // CONTROL_SCENE_CACHE_HPP
@@ -28,7 +28,10 @@
 
 /* Local includes */
 #include "../config/traits.hpp"
+#include "polylines.hpp"
+#include "segments.hpp"
 #include "shape.hpp"
+#include "../sys/thread_pool.hpp"
 
 namespace model
 {
@@ -56,33 +59,49 @@ namespace model
 		void transformation(const Matrix & world_T);
 		void w_transformation(const Matrix & window_T);
 
-		void draw(const Cairo::RefPtr<Cairo::Context>& cr, const Matrix & viewport_T);
+		void draw(Frame & frame);
 
 		virtual Vector mass_center() const;
 
 		virtual void perspective();
 
 		virtual std::string type();
+		virtual size_t vertices() const;
 
 		static const double precision;
 		static const double world_max_size;
 		static const double window_max_size;
 
+	protected:
+		//! Surfaces lie in the hull of their control points
+		virtual Box world_bounds() const;
+
 	private:
 		std::vector<std::vector<Vector>> _control_vectors;
-		std::vector<std::vector<Vector>> _surface_vectors;
+		Polylines _surface_vectors;
+		Polylines _clipped;  //!< Swapped with _surface_vectors: keeps both allocations
+		std::vector<Vector> _tessellation;  //!< World space lines, steps() points each
+
+		//! Evaluates the lines of the surface into _tessellation
+		void tessellate();
+
+		/* Both directions of the patch at controls (m, n): 2 steps() lines */
+		void patch(size_t m, size_t n, Vector * out) const;
 
-		Matrix build_snip(COORD coord, int i, int j);
+		//! Lines per direction of a patch, and points per line
+		static size_t steps();
+
+		Matrix build_snip(COORD coord, int i, int j) const;
 
 		bool over_perpendicular_edges(const Vector & pa, const Vector & pb);
 
-		void foward_update(Matrix & Gx, Matrix & Gy, Matrix & Gz);
+		void foward_update(Matrix & Gx, Matrix & Gy, Matrix & Gz) const;
 		void forward_differences(
 			std::vector<double> & dX,
 			std::vector<double> & dY,
 			std::vector<double> & dZ,
-			std::vector<Vector> & vectors
-		);
+			Vector * out
+		) const;
 	};
 
 /*================================================================================*/
@@ -99,10 +118,12 @@ namespace model
 			return;
 
 		for (auto & line : _control_vectors)
-			for (auto & v : line)
-				v = v * world_T;
+			kernel::transform_points(world_T, line);
 
+		_tessellation.clear();
 		_normal = _normal * world_T;
+		_dirty = true;
+		_bounded = false;
 	}
 
 	void BSplineSurface::w_transformation(const Matrix & window_T)
@@ -110,8 +131,36 @@ namespace model
 		if (_control_vectors.size() < 4)
 			return;
 
-		_surface_vectors.clear();
+		/* Evaluated once per change of the controls: the window only moves
+		 * the lines, as affine maps commute with the polynomials */
+		if (_tessellation.empty())
+			tessellate();
+
+		const size_t n = steps();
+
+		_surface_vectors.assign(_tessellation.size() / n, n);
+
+		sys::ThreadPool::instance().parallel_for(0, _surface_vectors.size(), Traits<sys::ThreadPool>::grain, [&](size_t l) {
+			kernel::transform_points(window_T, &_tessellation[l * n][0], &_surface_vectors.begin(l)[0][0], n);
+		});
+	}
 
+	void BSplineSurface::tessellate()
+	{
+		const size_t cols = _control_vectors[0].size() - 3;
+		const size_t patches = (_control_vectors.size() - 3) * cols;
+		const size_t lines = 2 * steps();
+
+		/* Each patch owns its slots: the order does not depend on threads */
+		_tessellation.resize(patches * lines * steps());
+
+		sys::ThreadPool::instance().parallel_for(0, patches, 1, [&](size_t p) {
+			patch(p / cols, p % cols, &_tessellation[p * lines * steps()]);
+		});
+	}
+
+	void BSplineSurface::patch(size_t m, size_t n, Vector * out) const
+	{
 		static const Matrix Ds{
 			{                    0.0,                     0.0,         0.0, 1.0},
 			{1.0 * pow(precision, 3), 1.0 * pow(precision, 2),   precision, 0.0},
@@ -136,65 +185,61 @@ namespace model
 		static const Matrix S = Ds.multiply<4>(IMbs);
 		static const Matrix T = IMbs.multiply<4>(Dt);
 
-		for (size_t m = 0; m < _control_vectors.size() - 3; ++m)
+		auto Gx = S.multiply<4>(build_snip(COORD::x, m, n).multiply<4>(T));
+		auto Gy = S.multiply<4>(build_snip(COORD::y, m, n).multiply<4>(T));
+		auto Gz = S.multiply<4>(build_snip(COORD::z, m, n).multiply<4>(T));
+
+		for (double k = 0; k < 1; k += precision)
+		{
+			if (k > 0)
+			{
+				std::vector<double> dX{Gx[0][0], Gx[0][1], Gx[0][2], Gx[0][3]};
+				std::vector<double> dY{Gy[0][0], Gy[0][1], Gy[0][2], Gy[0][3]};
+				std::vector<double> dZ{Gz[0][0], Gz[0][1], Gz[0][2], Gz[0][3]};
+
+				forward_differences(dX, dY, dZ, out);
+				out += steps();
+			}
+
+			foward_update(Gx, Gy, Gz);
+		}
+
+		Gx = (S * build_snip(COORD::x, m, n) * T).transpose();
+		Gy = (S * build_snip(COORD::y, m, n) * T).transpose();
+		Gz = (S * build_snip(COORD::z, m, n) * T).transpose();
+
+		for (double k = 0; k < 1; k += precision)
 		{
-			for (size_t n = 0; n < _control_vectors[0].size() - 3; ++n)
+			if (k > 0)
 			{
-				auto Gx = S.multiply<4>(build_snip(COORD::x, m, n).multiply<4>(T));
-				auto Gy = S.multiply<4>(build_snip(COORD::y, m, n).multiply<4>(T));
-				auto Gz = S.multiply<4>(build_snip(COORD::z, m, n).multiply<4>(T));
-
-				std::vector<Vector> vectors;
-
-				for (double k = 0; k < 1; k += precision)
-				{
-					vectors.clear();
-
-					if (k > 0)
-					{
-						_surface_vectors.push_back({});
-						
-						std::vector<double> dX{Gx[0][0], Gx[0][1], Gx[0][2], Gx[0][3]};
-						std::vector<double> dY{Gy[0][0], Gy[0][1], Gy[0][2], Gy[0][3]};
-						std::vector<double> dZ{Gz[0][0], Gz[0][1], Gz[0][2], Gz[0][3]};
-
-						forward_differences(dX, dY, dZ, vectors);
-
-						for (auto &v: vectors)
-							_surface_vectors.back().push_back(v * window_T);
-					}
-				
-					foward_update(Gx, Gy, Gz);
-				}
-
-				Gx = (S * build_snip(COORD::x, m, n) * T).transpose();
-				Gy = (S * build_snip(COORD::y, m, n) * T).transpose();
-				Gz = (S * build_snip(COORD::z, m, n) * T).transpose();
-
-				for (double k = 0; k < 1; k += precision)
-				{
-					vectors.clear();
-
-					if (k > 0)
-					{
-						_surface_vectors.push_back({});
-						
-						std::vector<double> dX{Gx[0][0], Gx[0][1], Gx[0][2], Gx[0][3]};
-						std::vector<double> dY{Gy[0][0], Gy[0][1], Gy[0][2], Gy[0][3]};
-						std::vector<double> dZ{Gz[0][0], Gz[0][1], Gz[0][2], Gz[0][3]};
-
-						forward_differences(dX, dY, dZ, vectors);
-
-						for (auto &v: vectors)
-							_surface_vectors.back().push_back(v * window_T);
-					}
-				
-					foward_update(Gx, Gy, Gz);
-				}
+				std::vector<double> dX{Gx[0][0], Gx[0][1], Gx[0][2], Gx[0][3]};
+				std::vector<double> dY{Gy[0][0], Gy[0][1], Gy[0][2], Gy[0][3]};
+				std::vector<double> dZ{Gz[0][0], Gz[0][1], Gz[0][2], Gz[0][3]};
+
+				forward_differences(dX, dY, dZ, out);
+				out += steps();
 			}
+
+			foward_update(Gx, Gy, Gz);
 		}
 	}
 
+	size_t BSplineSurface::steps()
+	{
+		/* The loops of patch() skip k = 0, those of forward_differences()
+		 * start past it: both take one value less than k has over [0, 1) */
+		static const size_t count = []() {
+			size_t count = 0;
+
+			for (double k = precision; k < 1; k += precision)
+				++count;
+
+			return count;
+		}();
+
+		return count;
+	}
+
 	// void BSplineSurface::foward_update(Matrix &Gx, Matrix &Gy, Matrix &Gz)
 	// {
 	// 	for (int i = 0; i < 3; ++i)
@@ -209,12 +254,9 @@ namespace model
 		std::vector<double> & dX,
 		std::vector<double> & dY,
 		std::vector<double> & dZ,
-		std::vector<Vector> & vectors
-	)
+		Vector * out
+	) const
 	{
-		if (!vectors.empty())
-			vectors.emplace_back(dX[0], dY[0], dZ[0]);
-
 		for (double k = precision; k < 1; k += precision)
 		{
 			dX[0] += dX[1];
@@ -229,11 +271,11 @@ namespace model
 			dY[2] += dY[3];
 			dZ[2] += dZ[3];
 
-			vectors.emplace_back(dX[0], dY[0], dZ[0]);
+			*out++ = Vector(dX[0], dY[0], dZ[0]);
 		}
 	}
 
-	void BSplineSurface::foward_update(Matrix & Gx, Matrix & Gy, Matrix & Gz)
+	void BSplineSurface::foward_update(Matrix & Gx, Matrix & Gy, Matrix & Gz) const
 	{
 		Gx[0][0] += Gx[1][0];
 		Gx[0][1] += Gx[1][1];
@@ -286,93 +328,39 @@ namespace model
 
 	void BSplineSurface::clipping(const Vector & min, const Vector & max)
 	{
-		if (_surface_vectors.size() < 4)
+		if (_surface_vectors.empty())
 			return;
 
-		for (auto &line: _surface_vectors)
-		{
-			std::vector<Vector> vectors;
-
-			Vector aux;
-
-			for (size_t a = 0; a < line.size() - 1; ++a)
-			{
-				Vector pa = line[a];
-				Vector pb = line[a + 1];
-
-				double p4 = pb[1] - pa[1];
-				double p3 = -p4;
-				double p2 = pb[0] - pa[0];
-				double p1 = -p2;
-
-				double q1 = pa[0] - min[0];
-				double q2 = max[0] - pa[0];
-				double q3 = pa[1] - min[1];
-				double q4 = max[1] - pa[1];
-
-				double positive[5], negative[5];
-
-				int pos_index = 1, neg_index = 1;
-
-				positive[0] = 1;
-				negative[0] = 0;
-
-				if ((p1 == 0 && q1 < 0) || (p3 == 0 && q3 < 0))
-					continue;
-
-				if (p1 != 0)
-				{
-					double r1 = q1 / p1;
-					double r2 = q2 / p2;
-
-					negative[neg_index++] = p1 < 0 ? r1 : r2;
-					positive[pos_index++] = p1 < 0 ? r2 : r1;
-				}
-
-				if (p3 != 0)
-				{
-					double r3 = q3 / p3;
-					double r4 = q4 / p4;
+		/* Every line of the surface in one batch */
+		Segments segments;
+		std::vector<size_t> ends;
 
-					negative[neg_index++] = p3 < 0 ? r3: r4;
-					positive[pos_index++] = p3 < 0 ? r4: r3;
-				}
-
-				double rn1 = negative[0];
-				double rn2 = positive[0];
-
-				for (int i = 1; i < neg_index; ++i)
-					if (rn1 < negative[i])
-						rn1 = negative[i];
-
-				for (int i = 1; i < pos_index; ++i)
-					if (rn2 > positive[i])
-						rn2 = positive[i];
-
-				if (rn1 > rn2)
-					continue;
-
-				auto new_xa = pa[0] + p2 * rn1;
-				auto new_xb = pa[0] + p2 * rn2;
+		for (size_t l = 0; l < _surface_vectors.size(); ++l)
+		{
+			segments.add_polyline(_surface_vectors.begin(l), _surface_vectors.end(l) - _surface_vectors.begin(l));
+			ends.push_back(segments.size());
+		}
 
-				if (new_xa > max[0] && new_xb > max[0])
-					continue;
+		segments.clip(min, max);
 
-				auto new_ya = pa[1] + p4 * rn1;
-				auto new_yb = pa[1] + p4 * rn2;
+		size_t kept = 0;
+		_clipped.clear();
 
-				if (new_ya > max[1] && new_yb > max[1])
-					continue;
+		for (size_t l = 0; l < _surface_vectors.size(); ++l)
+		{
+			const size_t first = kept;
 
-				vectors.emplace_back(new_xa, new_ya);
-				vectors.emplace_back(new_xb, new_yb);
-			}
+			while (kept < segments.size() && segments.source(kept) < ends[l])
+				++kept;
 
-			line = vectors;
+			segments.points(first, kept, _clipped.vectors());
+			_clipped.close();
 		}
+
+		std::swap(_surface_vectors, _clipped);
 	}
 
-	Matrix BSplineSurface::build_snip(COORD coord, int i, int j)
+	Matrix BSplineSurface::build_snip(COORD coord, int i, int j) const
 	{
 		Matrix R( //! Result
 			{0.0, 0.0, 0.0, 0.0},
@@ -404,29 +392,33 @@ namespace model
 		return false;
 	}
 
-	void BSplineSurface::draw(const Cairo::RefPtr<Cairo::Context>& cr, const Matrix & viewport_T)
+	void BSplineSurface::draw(Frame & frame)
 	{
 		if (_surface_vectors.empty())
 			return;
 
-		for (const auto &curve: _surface_vectors)
+		for (size_t l = 0; l < _surface_vectors.size(); ++l)
 		{
+			const Vector * first = _surface_vectors.begin(l);
+			const Vector * last = _surface_vectors.end(l);
+
+			if (first == last)
+				continue;
+
 			/* First point to verify coordinates */
-			Vector v0 = curve[0] * viewport_T;
-			
-			cr->move_to(v0[0], v0[1]);
+			Vector v0 = *first;
+
+			frame.move_to(*first);
 
 			/* Draw all other points */
-			for (const Vector& v : curve)
+			for (const Vector * v = first; v != last; ++v)
 			{
-				Vector vi = v * viewport_T;
-
-				if (over_perpendicular_edges(v, v0))
-					cr->move_to(vi[0], vi[1]);
+				if (over_perpendicular_edges(*v, v0))
+					frame.move_to(*v);
 				else
-					cr->line_to(vi[0], vi[1]);
+					frame.line_to(*v);
 
-				v0 = v;
+				v0 = *v;
 			}
 		}
 	}
@@ -455,27 +447,28 @@ namespace model
 
 	void BSplineSurface::perspective()
 	{
-		const double d = Traits<model::Window>::perspective_factor;
+		_culled = !clip_space::project(_surface_vectors);
+	}
 
-		Matrix M(
-			{1, 0, 0, 0},
-			{0, 1, 0, 0},
-			{0, 0, 1, 0},
-			{0, 0, d, 1}
-		);
+	size_t BSplineSurface::vertices() const
+	{
+		size_t vertices = 0;
 
-		for (auto &line: _surface_vectors)
-			for (auto &v: line)
-			{
-				v = v * M;
-				
-				if (v[2] >= 0)
-					continue;
-
-				v[0] = v[0] * d / v[2];
-				v[1] = v[1] * d / v[2];
-				v[2] = d;
-			}
+		for (auto & line : _control_vectors)
+			vertices += line.size();
+
+		return vertices;
+	}
+
+	Box BSplineSurface::world_bounds() const
+	{
+		Box box;
+
+		for (auto & line : _control_vectors)
+			for (auto & v : line)
+				box.extend(v);
+
+		return box;
 	}
 
 	std::string BSplineSurface::type()
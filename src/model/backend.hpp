@@ -0,0 +1,98 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MODEL_BACKEND_HPP
+#define MODEL_BACKEND_HPP
+
+/* External includes */
+#include <gtkmm/drawingarea.h>
+
+/* Local includes */
+#include "../config/traits.hpp"
+#include "frame.hpp"
+#include "geometry.hpp"
+
+namespace model
+{
+
+/*================================================================================*/
+/*                                   Definitions                                  */
+/*================================================================================*/
+
+	/* Turns the paths of a frame into pixels. Viewport paints with the one
+	 * of Backend::kind, over a cleared surface, in black. */
+	class Backend
+	{
+	public:
+		enum class Kind
+		{
+			Cairo,  //!< Cairo strokes every path
+			Raster  //!< Lines rasterized in software, blitted once (see Raster)
+		};
+
+		static Kind kind;
+
+		virtual ~Backend() = default;
+
+		/* Draws frame on cr, a width x height pixels surface */
+		virtual void draw(
+			const Cairo::RefPtr<Cairo::Context>& cr,
+			const Frame & frame,
+			const Matrix & viewport_T,
+			int width,
+			int height
+		) = 0;
+	};
+
+	class CairoBackend : public Backend
+	{
+	public:
+		void draw(
+			const Cairo::RefPtr<Cairo::Context>& cr,
+			const Frame & frame,
+			const Matrix & viewport_T,
+			int width,
+			int height
+		) override;
+	};
+
+/*================================================================================*/
+/*                                 Implementaions                                 */
+/*================================================================================*/
+
+	Backend::Kind Backend::kind{Backend::Kind::Cairo};
+
+	void CairoBackend::draw(
+		const Cairo::RefPtr<Cairo::Context>& cr,
+		const Frame & frame,
+		const Matrix & viewport_T,
+		int width,
+		int height
+	)
+	{
+		frame.draw(cr, viewport_T);
+	}
+
+} //! namespace model
+
+#endif  // MODEL_BACKEND_HPP
@@ -28,7 +28,10 @@
 
 /* Local includes */
 #include "../config/traits.hpp"
+#include "polylines.hpp"
+#include "segments.hpp"
 #include "shape.hpp"
+#include "../sys/thread_pool.hpp"
 
 namespace model
 {
@@ -56,24 +59,40 @@ namespace model
 		void transformation(const Matrix & world_T);
 		void w_transformation(const Matrix & window_T);
 
-		void draw(const Cairo::RefPtr<Cairo::Context>& cr, const Matrix & viewport_T);
+		void draw(Frame & frame);
 
 		virtual Vector mass_center() const;
 
 		virtual void perspective();
 
 		virtual std::string type();
+		virtual size_t vertices() const;
 
 		static const double precision;
 		static const double world_max_size;
 		static const double window_max_size;
 
+	protected:
+		//! Surfaces lie in the hull of their control points
+		virtual Box world_bounds() const;
+
 	private:
 		std::vector<std::vector<Vector>> _control_vectors;
-		std::vector<std::vector<Vector>> _surface_vectors;
+		Polylines _surface_vectors;
+		Polylines _clipped;  //!< Swapped with _surface_vectors: keeps both allocations
+		std::vector<Vector> _tessellation;  //!< World space lines, steps() points each
+
+		//! Evaluates the lines of the surface into _tessellation
+		void tessellate();
+
+		/* Rows then columns of the patch at controls (m, n): 2 steps() lines */
+		void patch(size_t m, size_t n, Vector * out) const;
+
+		//! Values s and t take over [0, 1]
+		static size_t steps();
 
 		bool over_perpendicular_edges(const Vector & pa, const Vector & pb);
-		Matrix build_snip(COORD coord, int i, int j, const Matrix & W);
+		Matrix build_snip(COORD coord, int i, int j, const std::vector<std::vector<Vector>> & controls) const;
 	};
 
 /*================================================================================*/
@@ -90,10 +109,12 @@ namespace model
 			return;
 
 		for (auto & line : _control_vectors)
-			for (auto & v : line)
-				v = v * world_T;
+			kernel::transform_points(world_T, line);
 
+		_tessellation.clear();
 		_normal = _normal * world_T;
+		_dirty = true;
+		_bounded = false;
 	}
 
 	void BezierSurface::w_transformation(const Matrix & window_T)
@@ -101,8 +122,36 @@ namespace model
 		if (_control_vectors.size() < 4)
 			return;
 
-		_surface_vectors.clear();
-		
+		/* Evaluated once per change of the controls: the window only moves
+		 * the lines, as affine maps commute with the polynomials */
+		if (_tessellation.empty())
+			tessellate();
+
+		const size_t n = steps();
+
+		_surface_vectors.assign(_tessellation.size() / n, n);
+
+		sys::ThreadPool::instance().parallel_for(0, _surface_vectors.size(), Traits<sys::ThreadPool>::grain, [&](size_t l) {
+			kernel::transform_points(window_T, &_tessellation[l * n][0], &_surface_vectors.begin(l)[0][0], n);
+		});
+	}
+
+	void BezierSurface::tessellate()
+	{
+		const size_t rows = (_control_vectors.size() - 1) / 3;
+		const size_t cols = (_control_vectors.front().size() - 1) / 3;
+		const size_t lines = 2 * steps();
+
+		/* Each patch owns its slots: the order does not depend on threads */
+		_tessellation.resize(rows * cols * lines * steps());
+
+		sys::ThreadPool::instance().parallel_for(0, rows * cols, 1, [&](size_t p) {
+			patch(3 * (p / cols), 3 * (p % cols), &_tessellation[p * lines * steps()]);
+		});
+	}
+
+	void BezierSurface::patch(size_t m, size_t n, Vector * out) const
+	{
 		static const Matrix M{
 			{-1.0,  3.0, -3.0, 1.0},
 			{ 3.0, -6.0,  3.0, 0.0},
@@ -110,145 +159,84 @@ namespace model
 			{ 1.0,  0.0,  0.0, 0.0}
 		};
 
-		/* Amount of anothers bezier curves interconnected */
-		std::vector<std::vector<Vector>> lines;
+		const size_t count = steps();
 
-		for (size_t m = 0; m < _control_vectors.size() - 1; m += 3)
-		{
-			for (size_t n = 0; n < _control_vectors.front().size() - 1; n += 3)
-			{
-				size_t si = 0;
-
-				const auto Mx = build_snip(COORD::x, m, n, window_T) * M;
-				const auto My = build_snip(COORD::y, m, n, window_T) * M;
-				const auto Mz = build_snip(COORD::z, m, n, window_T) * M;
-
-				for (double s = 0; s <= 1.0; s += precision, ++si)
-				{
-					lines.push_back({});
-
-					const Vector sx = Vector{s*s*s, s*s, s, 1}.multiply<4>(M) * Mx;
-					const Vector sy = Vector{s*s*s, s*s, s, 1}.multiply<4>(M) * My;
-					const Vector sz = Vector{s*s*s, s*s, s, 1}.multiply<4>(M) * Mz;
-
-					for (double t = 0; t <= 1.0; t += precision)
-					{
-						const std::vector<double> vt{t*t*t, t*t, t, 1};
+		const auto Mx = build_snip(COORD::x, m, n, _control_vectors) * M;
+		const auto My = build_snip(COORD::y, m, n, _control_vectors) * M;
+		const auto Mz = build_snip(COORD::z, m, n, _control_vectors) * M;
 
-						double x = sx * vt;
-						double y = sy * vt;
-						double z = sz * vt;
+		size_t si = 0;
 
-			            lines[si].emplace_back(x, y, z);
-					}
-				}
-
-				std::vector<std::vector<Vector>> columns(lines[0].size());
+		for (double s = 0; s <= 1.0; s += precision, ++si)
+		{
+			const Vector sx = Vector{s*s*s, s*s, s, 1}.multiply<4>(M) * Mx;
+			const Vector sy = Vector{s*s*s, s*s, s, 1}.multiply<4>(M) * My;
+			const Vector sz = Vector{s*s*s, s*s, s, 1}.multiply<4>(M) * Mz;
 
-				for (size_t j = 0; j < lines[0].size(); ++j)
-					for (size_t i = 0; i < lines.size(); ++i)
-						columns[j].push_back(lines[i][j]);
+			size_t ti = 0;
 
-				for (auto line: lines)
-					_surface_vectors.push_back(line);
+			for (double t = 0; t <= 1.0; t += precision, ++ti)
+			{
+				const std::vector<double> vt{t*t*t, t*t, t, 1};
 
-				for (auto line: columns)
-					_surface_vectors.push_back(line);
+				const Vector v(sx * vt, sy * vt, sz * vt);
 
-				lines.clear();
+				/* Row si and column ti of the grid */
+				out[si * count + ti] = v;
+				out[(count + ti) * count + si] = v;
 			}
 		}
 	}
 
-	void BezierSurface::clipping(const Vector & min, const Vector & max)
+	size_t BezierSurface::steps()
 	{
-		if (_surface_vectors.size() < 4)
-			return;
-
-		for (auto &line: _surface_vectors)
-		{
-			std::vector<Vector> vectors;
-
-			Vector aux;
-
-			for (size_t a = 0; a < line.size() - 1; ++a)
-			{
-				Vector pa = line[a];
-				Vector pb = line[a + 1];
-
-				double p4 = pb[1] - pa[1];
-				double p3 = -p4;
-				double p2 = pb[0] - pa[0];
-				double p1 = -p2;
-
-				double q1 = pa[0] - min[0];
-				double q2 = max[0] - pa[0];
-				double q3 = pa[1] - min[1];
-				double q4 = max[1] - pa[1];
+		static const size_t count = []() {
+			size_t count = 0;
 
-				double positive[5], negative[5];
+			for (double s = 0; s <= 1.0; s += precision)
+				++count;
 
-				int pos_index = 1, neg_index = 1;
+			return count;
+		}();
 
-				positive[0] = 1;
-				negative[0] = 0;
-
-				if ((p1 == 0 && q1 < 0) || (p3 == 0 && q3 < 0))
-					continue;
-
-				if (p1 != 0)
-				{
-					double r1 = q1 / p1;
-					double r2 = q2 / p2;
-
-					negative[neg_index++] = p1 < 0 ? r1 : r2;
-					positive[pos_index++] = p1 < 0 ? r2 : r1;
-				}
-
-				if (p3 != 0)
-				{
-					double r3 = q3 / p3;
-					double r4 = q4 / p4;
-
-					negative[neg_index++] = p3 < 0 ? r3: r4;
-					positive[pos_index++] = p3 < 0 ? r4: r3;
-				}
-
-				double rn1 = negative[0];
-				double rn2 = positive[0];
-
-				for (int i = 1; i < neg_index; ++i)
-					if (rn1 < negative[i])
-						rn1 = negative[i];
+		return count;
+	}
 
-				for (int i = 1; i < pos_index; ++i)
-					if (rn2 > positive[i])
-						rn2 = positive[i];
+	void BezierSurface::clipping(const Vector & min, const Vector & max)
+	{
+		if (_surface_vectors.empty())
+			return;
 
-				if (rn1 > rn2)
-					continue;
+		/* Every line of the surface in one batch */
+		Segments segments;
+		std::vector<size_t> ends;
 
-				auto new_xa = pa[0] + p2 * rn1;
-				auto new_xb = pa[0] + p2 * rn2;
+		for (size_t l = 0; l < _surface_vectors.size(); ++l)
+		{
+			segments.add_polyline(_surface_vectors.begin(l), _surface_vectors.end(l) - _surface_vectors.begin(l));
+			ends.push_back(segments.size());
+		}
 
-				if (new_xa > max[0] && new_xb > max[0])
-					continue;
+		segments.clip(min, max);
 
-				auto new_ya = pa[1] + p4 * rn1;
-				auto new_yb = pa[1] + p4 * rn2;
+		size_t kept = 0;
+		_clipped.clear();
 
-				if (new_ya > max[1] && new_yb > max[1])
-					continue;
+		for (size_t l = 0; l < _surface_vectors.size(); ++l)
+		{
+			const size_t first = kept;
 
-				vectors.emplace_back(new_xa, new_ya);
-				vectors.emplace_back(new_xb, new_yb);
-			}
+			while (kept < segments.size() && segments.source(kept) < ends[l])
+				++kept;
 
-			line = vectors;
+			segments.points(first, kept, _clipped.vectors());
+			_clipped.close();
 		}
+
+		std::swap(_surface_vectors, _clipped);
 	}
 
-	Matrix BezierSurface::build_snip(COORD coord, int i, int j, const Matrix & W)
+	Matrix BezierSurface::build_snip(COORD coord, int i, int j, const std::vector<std::vector<Vector>> & controls) const
 	{
 		Matrix R( //! Result
 			{0.0, 0.0, 0.0, 0.0},
@@ -259,7 +247,7 @@ namespace model
 
 		for (int m = i; m < i + 4; ++m)
 			for (int n = j; n < j + 4; ++n)
-				R[m - i][n - j] = (_control_vectors[m][n] * W)[coord];
+				R[m - i][n - j] = controls[m][n][coord];
 		return std::move(R);
 	}
 
@@ -279,29 +267,33 @@ namespace model
 		return false;
 	}
 
-	void BezierSurface::draw(const Cairo::RefPtr<Cairo::Context>& cr, const Matrix & viewport_T)
+	void BezierSurface::draw(Frame & frame)
 	{
 		if (_surface_vectors.empty())
 			return;
 
-		for (const auto &curve: _surface_vectors)
+		for (size_t l = 0; l < _surface_vectors.size(); ++l)
 		{
+			const Vector * first = _surface_vectors.begin(l);
+			const Vector * last = _surface_vectors.end(l);
+
+			if (first == last)
+				continue;
+
 			/* First point to verify coordinates */
-			Vector v0 = curve[0] * viewport_T;
-			
-			cr->move_to(v0[0], v0[1]);
+			Vector v0 = *first;
+
+			frame.move_to(*first);
 
 			/* Draw all other points */
-			for (const Vector& v : curve)
+			for (const Vector * v = first; v != last; ++v)
 			{
-				Vector vi = v * viewport_T;
-
-				if (over_perpendicular_edges(v, v0))
-					cr->move_to(vi[0], vi[1]);
+				if (over_perpendicular_edges(*v, v0))
+					frame.move_to(*v);
 				else
-					cr->line_to(vi[0], vi[1]);
+					frame.line_to(*v);
 
-				v0 = v;
+				v0 = *v;
 			}
 		}
 	}
@@ -330,27 +322,28 @@ namespace model
 
 	void BezierSurface::perspective()
 	{
-		const double d = Traits<model::Window>::perspective_factor;
+		_culled = !clip_space::project(_surface_vectors);
+	}
 
-		Matrix M(
-			{1, 0, 0, 0},
-			{0, 1, 0, 0},
-			{0, 0, 1, 0},
-			{0, 0, d, 1}
-		);
+	size_t BezierSurface::vertices() const
+	{
+		size_t vertices = 0;
 
-		for (auto &line: _surface_vectors)
-			for (auto &v: line)
-			{
-				v = v * M;
-				
-				if (v[2] >= 0)
-					continue;
-
-				v[0] = v[0] * d / v[2];
-				v[1] = v[1] * d / v[2];
-				v[2] = d;
-			}
+		for (auto & line : _control_vectors)
+			vertices += line.size();
+
+		return vertices;
+	}
+
+	Box BezierSurface::world_bounds() const
+	{
+		Box box;
+
+		for (auto & line : _control_vectors)
+			for (auto & v : line)
+				box.extend(v);
+
+		return box;
 	}
 
 	std::string BezierSurface::type()
@@ -0,0 +1,233 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MODEL_BOX_HPP
+#define MODEL_BOX_HPP
+
+/* External includes */
+#include <algorithm>
+#include <limits>
+
+/* Local includes */
+#include "../config/traits.hpp"
+#include "geometry.hpp"
+
+namespace model
+{
+
+/*================================================================================*/
+/*                                   Definitions                                  */
+/*================================================================================*/
+
+	/* Axis-aligned bounding box over x, y and z. Starts empty. */
+	class Box
+	{
+	public:
+		Box() = default;
+
+		Box(const Vector & min, const Vector & max) :
+			_min(min),
+			_max(max)
+		{}
+
+		~Box() = default;
+
+		void extend(const Vector & v);
+		void extend(const Box & b);
+
+		bool empty() const;
+		double center(int axis) const;
+		int longest_axis() const;
+
+		const Vector & min() const;
+		const Vector & max() const;
+
+		/* Bounds the image of the box: affine transformations map it into
+		 * the hull of its transformed corners */
+		Box transformed(const Matrix & T) const;
+
+		/* Bounds the image of the box under Shape::perspective(). Empty when
+		 * no part of it lies between the near and far planes. */
+		Box projected(double d) const;
+
+	private:
+		static constexpr double infinity = std::numeric_limits<double>::infinity();
+
+		Vector _min{infinity, infinity, infinity};
+		Vector _max{-infinity, -infinity, -infinity};
+	};
+
+	/* The normalized window as the renderer sees it: window transformation,
+	 * then perspective, then clipping against [min, max] in x and y. */
+	class ViewVolume
+	{
+	public:
+		ViewVolume(const Matrix & window_T, const Vector & min, const Vector & max) :
+			_window_T(window_T),
+			_min(min),
+			_max(max)
+		{}
+
+		~ViewVolume() = default;
+
+		enum Side {OUTSIDE, CROSSING, INSIDE};
+
+		/* OUTSIDE only when nothing in the world box can reach the window,
+		 * INSIDE only when clipping would keep all of it */
+		Side side(const Box & world) const;
+		bool outside(const Box & world) const;
+
+	private:
+		//! Rounding slack between the box test and the per-vertex path
+		static constexpr double epsilon = 1e-9;
+
+		const Matrix & _window_T;
+		const Vector _min, _max;
+	};
+
+/*================================================================================*/
+/*                                 Implementaions                                 */
+/*================================================================================*/
+
+	constexpr double Box::infinity;
+	constexpr double ViewVolume::epsilon;
+
+	void Box::extend(const Vector & v)
+	{
+		for (int i = 0; i < 3; ++i)
+		{
+			_min[i] = std::min(_min[i], v[i]);
+			_max[i] = std::max(_max[i], v[i]);
+		}
+	}
+
+	void Box::extend(const Box & b)
+	{
+		if (b.empty())
+			return;
+
+		extend(b._min);
+		extend(b._max);
+	}
+
+	bool Box::empty() const
+	{
+		return _min[0] > _max[0];
+	}
+
+	double Box::center(int axis) const
+	{
+		return (_min[axis] + _max[axis]) / 2;
+	}
+
+	int Box::longest_axis() const
+	{
+		const double dx = _max[0] - _min[0];
+		const double dy = _max[1] - _min[1];
+		const double dz = _max[2] - _min[2];
+
+		return dx >= dy && dx >= dz ? 0 : (dy >= dz ? 1 : 2);
+	}
+
+	const Vector & Box::min() const
+	{
+		return _min;
+	}
+
+	const Vector & Box::max() const
+	{
+		return _max;
+	}
+
+	Box Box::transformed(const Matrix & T) const
+	{
+		Box box;
+
+		if (empty())
+			return box;
+
+		for (int corner = 0; corner < 8; ++corner)
+		{
+			const Vector v(
+				corner & 1 ? _max[0] : _min[0],
+				corner & 2 ? _max[1] : _min[1],
+				corner & 4 ? _max[2] : _min[2]
+			);
+
+			box.extend(v * T);
+		}
+
+		return box;
+	}
+
+	//! Shape::perspective(): x, y scaled by -d / w, w = -(z + d) kept in [near_plane, far_plane]
+	Box Box::projected(double d) const
+	{
+		if (empty())
+			return *this;
+
+		const double nearest = std::max(-(_max[2] + d), Traits<Window>::near_plane);
+		const double farthest = std::min(-(_min[2] + d), Traits<Window>::far_plane);
+
+		//! Behind the eye or past the far plane: clip space rejects all of it
+		if (nearest > farthest)
+			return Box();
+
+		/* x * d / z is bilinear in x and 1 / z: extremes lie on the corners */
+		Box box;
+
+		for (double w : {nearest, farthest})
+			for (double x : {_min[0], _max[0]})
+				for (double y : {_min[1], _max[1]})
+					box.extend(Vector(x * -d / w, y * -d / w, d));
+
+		return box;
+	}
+
+	ViewVolume::Side ViewVolume::side(const Box & world) const
+	{
+		Box box = world.transformed(_window_T);
+
+		if (Traits<Window>::has_perspective)
+			box = box.projected(Traits<Window>::perspective_factor);
+
+		if (box.empty()
+			|| box.max()[0] < _min[0] - epsilon || box.min()[0] > _max[0] + epsilon
+			|| box.max()[1] < _min[1] - epsilon || box.min()[1] > _max[1] + epsilon)
+			return OUTSIDE;
+
+		if (box.min()[0] > _min[0] + epsilon && box.max()[0] < _max[0] - epsilon
+			&& box.min()[1] > _min[1] + epsilon && box.max()[1] < _max[1] - epsilon)
+			return INSIDE;
+
+		return CROSSING;
+	}
+
+	bool ViewVolume::outside(const Box & world) const
+	{
+		return side(world) == OUTSIDE;
+	}
+
+} //! namespace model
+
+#endif  // MODEL_BOX_HPP
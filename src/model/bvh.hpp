@@ -0,0 +1,216 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MODEL_BVH_HPP
+#define MODEL_BVH_HPP
+
+/* External includes */
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+/* Local includes */
+#include "../config/traits.hpp"
+#include "box.hpp"
+
+namespace model
+{
+
+/*================================================================================*/
+/*                                   Definitions                                  */
+/*================================================================================*/
+
+	/* Bounding volume hierarchy over a set of boxes, split at the median of
+	 * the longest axis. Nodes are stored depth first: a left child follows
+	 * its parent. Leaves hold up to Traits<BVH>::leaf items. */
+	class BVH
+	{
+	public:
+		struct Node
+		{
+			Box box;
+			unsigned first;  //!< First item of the subtree
+			unsigned count;  //!< Items in the subtree
+			unsigned right;  //!< Right child, 0 for leaves
+		};
+
+		BVH()  = default;
+		~BVH() = default;
+
+		void build(const std::vector<Box> & boxes);
+
+		/* New boxes for the same items, keeping the tree: for rigid moves */
+		void refit(const std::vector<Box> & boxes);
+
+		bool empty() const;
+		const std::vector<Node> & nodes() const;
+
+		/* Items ordered so that every subtree owns a contiguous run */
+		const std::vector<unsigned> & items() const;
+
+		/* Calls visit(node index) for the fewest nodes covering every item
+		 * whose leaf is not outside view: whole subtrees inside it are
+		 * visited at their root */
+		template<typename F>
+		void query(const ViewVolume & view, const F & visit) const;
+
+	private:
+		unsigned build(const std::vector<Box> & boxes, const std::vector<Vector> & centers, unsigned first, unsigned last);
+		Box fit(const std::vector<Box> & boxes, unsigned index) const;
+
+		std::vector<Node> _nodes;
+		std::vector<unsigned> _items;
+	};
+
+/*================================================================================*/
+/*                                 Implementaions                                 */
+/*================================================================================*/
+
+	void BVH::build(const std::vector<Box> & boxes)
+	{
+		_nodes.clear();
+		_items.resize(boxes.size());
+		std::iota(_items.begin(), _items.end(), 0);
+
+		if (boxes.empty())
+			return;
+
+		std::vector<Vector> centers;
+		centers.reserve(boxes.size());
+
+		for (auto & b : boxes)
+			centers.emplace_back(b.center(0), b.center(1), b.center(2));
+
+		_nodes.reserve(2 * boxes.size() / Traits<BVH>::leaf + 1);
+		build(boxes, centers, 0, boxes.size());
+	}
+
+	unsigned BVH::build(const std::vector<Box> & boxes, const std::vector<Vector> & centers, unsigned first, unsigned last)
+	{
+		const unsigned index = _nodes.size();
+		_nodes.push_back({Box(), first, last - first, 0});
+
+		Box spread;
+
+		for (unsigned i = first; i < last; ++i)
+			if (!boxes[_items[i]].empty())
+				spread.extend(centers[_items[i]]);
+
+		if (last - first <= Traits<BVH>::leaf || spread.empty())
+		{
+			_nodes[index].box = fit(boxes, index);
+			return index;
+		}
+
+		const int axis = spread.longest_axis();
+		const unsigned middle = first + (last - first) / 2;
+
+		std::nth_element(_items.begin() + first, _items.begin() + middle, _items.begin() + last,
+			[&](unsigned a, unsigned b) {
+				return centers[a][axis] < centers[b][axis];
+			});
+
+		build(boxes, centers, first, middle);
+		const unsigned right = build(boxes, centers, middle, last);
+
+		_nodes[index].right = right;
+		_nodes[index].box = fit(boxes, index);
+
+		return index;
+	}
+
+	void BVH::refit(const std::vector<Box> & boxes)
+	{
+		//! Children come after their parent
+		for (size_t n = _nodes.size(); n-- > 0; )
+			_nodes[n].box = fit(boxes, n);
+	}
+
+	//! Leaves bound their items, inner nodes their children
+	Box BVH::fit(const std::vector<Box> & boxes, unsigned index) const
+	{
+		const Node & node = _nodes[index];
+		Box box;
+
+		if (node.right)
+		{
+			box.extend(_nodes[index + 1].box);
+			box.extend(_nodes[node.right].box);
+		}
+		else
+		{
+			for (unsigned i = node.first; i < node.first + node.count; ++i)
+				box.extend(boxes[_items[i]]);
+		}
+
+		return box;
+	}
+
+	bool BVH::empty() const
+	{
+		return _nodes.empty();
+	}
+
+	const std::vector<BVH::Node> & BVH::nodes() const
+	{
+		return _nodes;
+	}
+
+	const std::vector<unsigned> & BVH::items() const
+	{
+		return _items;
+	}
+
+	template<typename F>
+	void BVH::query(const ViewVolume & view, const F & visit) const
+	{
+		if (_nodes.empty())
+			return;
+
+		std::vector<unsigned> stack{0};
+
+		while (!stack.empty())
+		{
+			const unsigned index = stack.back();
+			stack.pop_back();
+
+			const Node & node = _nodes[index];
+			const ViewVolume::Side side = view.side(node.box);
+
+			if (side == ViewVolume::OUTSIDE)
+				continue;
+
+			if (side == ViewVolume::INSIDE || !node.right)
+			{
+				visit(index);
+				continue;
+			}
+
+			stack.push_back(node.right);
+			stack.push_back(index + 1);
+		}
+	}
+
+} //! namespace model
+
+#endif  // MODEL_BVH_HPP
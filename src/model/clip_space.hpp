@@ -0,0 +1,302 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MODEL_CLIP_SPACE_HPP
+#define MODEL_CLIP_SPACE_HPP
+
+/* External includes */
+#include <algorithm>
+#include <vector>
+
+/* Local includes */
+#include "../config/traits.hpp"
+#include "geometry.hpp"
+#include "kernel.hpp"
+#include "polylines.hpp"
+
+namespace model
+{
+
+/*================================================================================*/
+/*                                   Definitions                                  */
+/*================================================================================*/
+
+	/* Window coordinates under the perspective, before the divide: w is the
+	 * distance to the eye. Only vectors between the near and far planes can
+	 * be divided, so those two planes are clipped here; x and y are clipped
+	 * in 2D afterwards, like without perspective. */
+	namespace clip_space
+	{
+		enum Plane
+		{
+			NEAR = 0x1, /*< 01 */
+			FAR  = 0x2, /*< 10 */
+		};
+
+		//! x, y scaled by -d, w = -(z + d): x / w is exactly x * d / (z + d)
+		const Matrix & projection();
+
+		unsigned outcode(double w);
+		unsigned outcode(const Vector & v);
+
+		/* x / w, y / w, and 1 / w as the depth z: it is linear on screen and
+		 * grows toward the eye */
+		Vector divide(const Vector & v);
+		void divide(std::vector<Vector> & vectors);
+
+		/* Clips vectors against both planes, as a polygon when closed. An open
+		 * path leaving and coming back is split: breaks gets the index where
+		 * each new piece starts. Returns false when nothing is left. */
+		bool clip(std::vector<Vector> & vectors, bool closed, std::vector<size_t> & breaks);
+
+		/* Projects, clips and divides open paths given in window coordinates:
+		 * the pieces of a split one become paths of their own */
+		bool project(Polylines & paths);
+
+		/* Anonymous namespace: This does not export the following features */
+		namespace
+		{
+			//! a + (b - a) * t, w included
+			Vector lerp(const Vector & a, const Vector & b, double t)
+			{
+				return Vector(
+					a[0] + (b[0] - a[0]) * t,
+					a[1] + (b[1] - a[1]) * t,
+					a[2] + (b[2] - a[2]) * t,
+					a[3] + (b[3] - a[3]) * t
+				);
+			}
+
+			//! Where ab meets the plane w = plane
+			Vector intersection(const Vector & a, const Vector & b, double plane)
+			{
+				return lerp(a, b, (plane - a[3]) / (b[3] - a[3]));
+			}
+
+			bool inside(const Vector & v, Plane plane)
+			{
+				return plane == NEAR ? v[3] >= Traits<Window>::near_plane : v[3] <= Traits<Window>::far_plane;
+			}
+
+			double distance(Plane plane)
+			{
+				return plane == NEAR ? Traits<Window>::near_plane : Traits<Window>::far_plane;
+			}
+
+			//! Sutherland-Hodgeman against one plane
+			void clip_polygon(std::vector<Vector> & vectors, Plane plane)
+			{
+				std::vector<Vector> clipped;
+				clipped.reserve(vectors.size() + 1);
+
+				for (size_t i = 0, k = vectors.size() - 1; i < vectors.size(); k = i++)
+				{
+					const Vector & previous = vectors[k];
+					const Vector & current = vectors[i];
+
+					if (inside(current, plane) != inside(previous, plane))
+						clipped.push_back(intersection(previous, current, distance(plane)));
+
+					if (inside(current, plane))
+						clipped.push_back(current);
+				}
+
+				vectors = std::move(clipped);
+			}
+
+			//! Liang-Barsky on w, one segment of a path
+			bool clip_segment(const Vector & a, const Vector & b, double & t0, double & t1)
+			{
+				t0 = 0;
+				t1 = 1;
+
+				for (Plane plane : {NEAR, FAR})
+				{
+					const bool a_in = inside(a, plane), b_in = inside(b, plane);
+
+					if (!a_in && !b_in)
+						return false;
+
+					if (a_in == b_in)
+						continue;
+
+					const double t = (distance(plane) - a[3]) / (b[3] - a[3]);
+
+					if (a_in)
+						t1 = std::min(t1, t);
+					else
+						t0 = std::max(t0, t);
+				}
+
+				return t0 <= t1;
+			}
+
+			void clip_path(std::vector<Vector> & vectors, std::vector<size_t> & breaks)
+			{
+				std::vector<Vector> clipped;
+				clipped.reserve(vectors.size());
+
+				/* Is the last vector of clipped the end of the current segment? */
+				bool joined = false;
+
+				for (size_t i = 0; i + 1 < vectors.size(); ++i)
+				{
+					double t0, t1;
+
+					if (!clip_segment(vectors[i], vectors[i + 1], t0, t1))
+					{
+						joined = false;
+						continue;
+					}
+
+					if (!joined)
+					{
+						if (!clipped.empty())
+							breaks.push_back(clipped.size());
+
+						clipped.push_back(t0 > 0 ? lerp(vectors[i], vectors[i + 1], t0) : vectors[i]);
+					}
+
+					clipped.push_back(t1 < 1 ? lerp(vectors[i], vectors[i + 1], t1) : vectors[i + 1]);
+					joined = t1 == 1;
+				}
+
+				vectors = std::move(clipped);
+			}
+		}
+	}
+
+/*================================================================================*/
+/*                                 Implementaions                                 */
+/*================================================================================*/
+
+	const Matrix & clip_space::projection()
+	{
+		static const double d = Traits<Window>::perspective_factor;
+
+		static const Matrix P(
+			{-d,  0,      0,  0},
+			{ 0, -d,      0,  0},
+			{ 0,  0,     -d, -1},
+			{ 0,  0, -d * d, -d}
+		);
+
+		return P;
+	}
+
+	unsigned clip_space::outcode(double w)
+	{
+		return (w < Traits<Window>::near_plane ? NEAR : 0) | (w > Traits<Window>::far_plane ? FAR : 0);
+	}
+
+	unsigned clip_space::outcode(const Vector & v)
+	{
+		return outcode(v[3]);
+	}
+
+	Vector clip_space::divide(const Vector & v)
+	{
+		return Vector(v[0] / v[3], v[1] / v[3], 1 / v[3]);
+	}
+
+	void clip_space::divide(std::vector<Vector> & vectors)
+	{
+		for (auto & v : vectors)
+			v = divide(v);
+	}
+
+	bool clip_space::clip(std::vector<Vector> & vectors, bool closed, std::vector<size_t> & breaks)
+	{
+		unsigned any = 0, all = NEAR | FAR;
+
+		for (auto & v : vectors)
+		{
+			const unsigned code = outcode(v);
+
+			any |= code;
+			all &= code;
+		}
+
+		/* Trivial cases: no vector crosses a plane, or all are past one */
+		if (!any)
+			return !vectors.empty();
+
+		if (all)
+		{
+			vectors.clear();
+			return false;
+		}
+
+		if (closed)
+		{
+			for (Plane plane : {NEAR, FAR})
+				if (!vectors.empty())
+					clip_polygon(vectors, plane);
+		}
+		else
+			clip_path(vectors, breaks);
+
+		return !vectors.empty();
+	}
+
+	bool clip_space::project(Polylines & paths)
+	{
+		auto & vectors = paths.vectors();
+		kernel::transform_points(projection(), vectors);
+
+		/* Trivial case: every vector between the planes divides in place */
+		if (std::none_of(vectors.begin(), vectors.end(), [](const Vector & v) { return outcode(v); }))
+		{
+			divide(vectors);
+			return !vectors.empty();
+		}
+
+		Polylines projected;
+		std::vector<Vector> path;
+		std::vector<size_t> breaks;
+
+		for (size_t l = 0; l < paths.size(); ++l)
+		{
+			path.assign(paths.begin(l), paths.end(l));
+			breaks.clear();
+
+			if (!clip(path, false, breaks))
+				continue;
+
+			divide(path);
+			breaks.push_back(path.size());
+
+			for (size_t b = 0, first = 0; b < breaks.size(); first = breaks[b++])
+			{
+				projected.vectors().insert(projected.vectors().end(), path.begin() + first, path.begin() + breaks[b]);
+				projected.close();
+			}
+		}
+
+		paths = std::move(projected);
+		return !paths.empty();
+	}
+
+} //! namespace model
+
+#endif  // MODEL_CLIP_SPACE_HPP
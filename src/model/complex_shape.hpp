@@ -24,10 +24,16 @@
 #ifndef MODEL_COMPLEX_SHAPE_HPP
 #define MODEL_COMPLEX_SHAPE_HPP
 
+/* External includes */
+#include <algorithm>
+#include <limits>
+
 /* Local includes */
 #include "../config/traits.hpp"
+#include "bvh.hpp"
 #include "geometry.hpp"
 #include "shape.hpp"
+#include "../sys/thread_pool.hpp"
 
 namespace model
 {
@@ -46,6 +52,19 @@ namespace model
 			_shapes(ss)
 		{
 			_normal = _normal + mass_center();
+			show_all();
+		}
+
+		/* Children index into buffer: each vertex is transformed once */
+		ComplexShape(std::string name,
+					 const std::vector<std::shared_ptr<Shape>>& ss,
+					 const std::shared_ptr<VertexBuffer>& buffer) :
+			Shape(name),
+			_shapes(ss)
+		{
+			_buffer = buffer;
+			_normal = _normal + mass_center();
+			show_all();
 		}
 
 		~ComplexShape() = default;
@@ -53,16 +72,37 @@ namespace model
 		Vector mass_center() const override;
 
 		void perspective() override;
+		void facing() override;
 		void clipping(const Vector & min, const Vector & max) override;
 
 		void w_transformation(const Matrix & window_T) override;
 		void transformation(const Matrix & world_T) override;
-		void draw(const Cairo::RefPtr<Cairo::Context>& cr, const Matrix & viewport_T) override;
+		void draw(Frame & frame) override;
 
 		std::string type() override;
 
+		const std::vector<std::shared_ptr<Shape>> & shapes() const;
+		size_t vertices() const override;
+
+		/* Keeps only the children whose BVH leaves reach view: until the next
+		 * cull, the pipeline transforms, clips and draws just those */
+		bool cull(const ViewVolume & view) override;
+
 	protected:
+		static const size_t grain = Traits<sys::ThreadPool>::grain;
+
+		Box world_bounds() const override;
+
+		void index();
+		void show_all();
+
 		std::vector<std::shared_ptr<Shape>> _shapes;
+
+		BVH _bvh;
+		bool _indexed{false};                             //!< _bvh matches the children
+		std::vector<VertexBuffer::Range> _node_ranges;    //!< Buffer vertices each subtree uses
+		std::vector<unsigned> _visible;                   //!< Children in view, in order
+		std::vector<VertexBuffer::Range> _ranges;         //!< Buffer vertices they use
 	};
 
 /*================================================================================*/
@@ -94,34 +134,202 @@ namespace model
 
 	void ComplexShape::w_transformation(const Matrix & window_T)
 	{
-		for (auto & s : _shapes)
-			s->w_transformation(window_T);
+		if (_buffer)
+			_buffer->w_transformation(window_T, _ranges);
+
+		sys::ThreadPool::instance().parallel_for(0, _visible.size(), grain, [&](size_t i) {
+			_shapes[_visible[i]]->w_transformation(window_T);
+		});
 	}
 
 	void ComplexShape::transformation(const Matrix & world_T)
 	{
-		for (auto & s : _shapes)
-			s->transformation(world_T);
+		if (_buffer)
+			_buffer->transformation(world_T);
+
+		sys::ThreadPool::instance().parallel_for(0, _shapes.size(), grain, [&](size_t i) {
+			_shapes[i]->transformation(world_T);
+		});
 
 		_normal = _normal * world_T;
+		_dirty = true;
+		_bounded = false;
+		_indexed = false;
+	}
+
+	void ComplexShape::facing()
+	{
+		sys::ThreadPool::instance().parallel_for(0, _visible.size(), grain, [&](size_t i) {
+			if (!_shapes[_visible[i]]->culled())
+				_shapes[_visible[i]]->facing();
+		});
 	}
 
 	void ComplexShape::clipping(const Vector & min, const Vector & max)
 	{
-		for (auto & s : _shapes)
-			s->clipping(min, max);
+		sys::ThreadPool::instance().parallel_for(0, _visible.size(), grain, [&](size_t i) {
+			if (!_shapes[_visible[i]]->culled())
+				_shapes[_visible[i]]->clipping(min, max);
+		});
 	}
 	
 	void ComplexShape::perspective()
 	{
-		for (auto & s : _shapes)
-			s->perspective();
+		if (_buffer)
+			_buffer->perspective(_ranges);
+
+		sys::ThreadPool::instance().parallel_for(0, _visible.size(), grain, [&](size_t i) {
+			_shapes[_visible[i]]->perspective();
+		});
+
+		//! Culled as a whole only when every child is behind the eye
+		_culled = std::all_of(_visible.begin(), _visible.end(), [&](unsigned i) {
+			return _shapes[i]->culled();
+		});
+	}
+
+	void ComplexShape::draw(Frame & frame)
+	{
+		for (auto i : _visible)
+			if (!_shapes[i]->culled())
+				_shapes[i]->draw(frame);
+	}
+
+	const std::vector<std::shared_ptr<Shape>> & ComplexShape::shapes() const
+	{
+		return _shapes;
+	}
+
+	//! A shared buffer is transformed once, whatever its children index
+	size_t ComplexShape::vertices() const
+	{
+		if (_buffer)
+			return _buffer->size();
+
+		size_t vertices = 0;
+
+		for (auto & shape : _shapes)
+			vertices += shape->vertices();
+
+		return vertices;
 	}
 
-	void ComplexShape::draw(const Cairo::RefPtr<Cairo::Context>& cr, const Matrix & viewport_T)
+	Box ComplexShape::world_bounds() const
 	{
-        for (auto & s : _shapes)
-			s->draw(cr, viewport_T);
+		Box box;
+
+		for (auto & shape : _shapes)
+			box.extend(shape->bounds());
+
+		return box;
+	}
+
+	//! Builds the BVH over the children and the buffer span of each subtree
+	void ComplexShape::index()
+	{
+		std::vector<Box> boxes;
+		boxes.reserve(_shapes.size());
+
+		for (auto & shape : _shapes)
+			boxes.push_back(shape->bounds());
+
+		_indexed = true;
+
+		/* Children only move together: the tree still groups them well */
+		if (!_bvh.empty())
+		{
+			_bvh.refit(boxes);
+			return;
+		}
+
+		_bvh.build(boxes);
+		_node_ranges.assign(_bvh.nodes().size(), {0, 0});
+
+		/* Children come after their parent: leaves first, then unions upwards */
+		for (size_t n = _bvh.nodes().size(); _buffer && n-- > 0; )
+		{
+			const auto & node = _bvh.nodes()[n];
+			VertexBuffer::Range range{std::numeric_limits<size_t>::max(), 0};
+
+			auto extend = [&](const VertexBuffer::Range & r) {
+				if (r.first < r.second)
+				{
+					range.first = std::min(range.first, r.first);
+					range.second = std::max(range.second, r.second);
+				}
+			};
+
+			if (node.right)
+			{
+				extend(_node_ranges[n + 1]);
+				extend(_node_ranges[node.right]);
+			}
+			else
+			{
+				for (unsigned i = node.first; i < node.first + node.count; ++i)
+					for (auto v : _shapes[_bvh.items()[i]]->indices())
+						extend({v, v + 1});
+			}
+
+			if (range.first < range.second)
+				_node_ranges[n] = range;
+		}
+	}
+
+	void ComplexShape::show_all()
+	{
+		_visible.resize(_shapes.size());
+
+		for (size_t i = 0; i < _visible.size(); ++i)
+			_visible[i] = i;
+
+		_ranges.clear();
+
+		if (_buffer)
+			_ranges.push_back({0, _buffer->size()});
+	}
+
+	bool ComplexShape::cull(const ViewVolume & view)
+	{
+		if (!_indexed)
+			index();
+
+		std::vector<bool> shown(_shapes.size());
+		_ranges.clear();
+
+		_bvh.query(view, [&](unsigned n) {
+			const auto & node = _bvh.nodes()[n];
+
+			for (unsigned i = node.first; i < node.first + node.count; ++i)
+				shown[_bvh.items()[i]] = true;
+
+			if (_node_ranges[n].first < _node_ranges[n].second)
+				_ranges.push_back(_node_ranges[n]);
+		});
+
+		/* Children draw in their original order, over merged vertex spans */
+		_visible.clear();
+
+		for (size_t i = 0; i < shown.size(); ++i)
+			if (shown[i])
+				_visible.push_back(i);
+
+		std::sort(_ranges.begin(), _ranges.end());
+
+		size_t merged = 0;
+
+		for (size_t i = 0; i < _ranges.size(); ++i)
+		{
+			if (merged && _ranges[i].first <= _ranges[merged - 1].second)
+				_ranges[merged - 1].second = std::max(_ranges[merged - 1].second, _ranges[i].second);
+			else
+				_ranges[merged++] = _ranges[i];
+		}
+
+		_ranges.resize(merged);
+
+		_culled = _visible.empty();
+		return _culled;
 	}
 
 	std::string ComplexShape::type()
@@ -0,0 +1,381 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MODEL_FRAME_HPP
+#define MODEL_FRAME_HPP
+
+/* External includes */
+#include <algorithm>
+#include <vector>
+#include <gtkmm/drawingarea.h>
+
+/* Local includes */
+#include "../config/traits.hpp"
+#include "geometry.hpp"
+
+namespace model
+{
+
+/*================================================================================*/
+/*                                   Definitions                                  */
+/*================================================================================*/
+
+	/* Immutable once published: the paths of every shape, in window coordinates.
+	 * Paths are batched per style, each handed to Cairo as one path: a frame
+	 * costs a fill and two strokes, however many shapes it holds. Filled paths
+	 * keep the depth of their points (see clip_space::divide) for Raster. */
+	class Frame
+	{
+	public:
+		Frame()  = default;
+		~Frame() = default;
+
+		void move_to(const Vector & v);
+		void line_to(const Vector & v);
+		void close_path();
+		void fill();   //!< Ends the path of a shape as a polygon filled in gray, then outlined
+		void stroke(); //!< Ends the path of a shape
+
+		void clear();
+		bool empty() const;
+
+		size_t points() const;   //!< Move and Line commands
+		size_t segments() const; //!< Line commands
+
+		/* Fills below strokes: every fill and its outline, then every stroke */
+		void draw(const Cairo::RefPtr<Cairo::Context>& cr, const Matrix & viewport_T) const;
+
+		/* Through viewport_T, appends every segment of the paths only stroked
+		 * as x0, y0, x1, y1, and of the outlines of fills as x0, y0, z0, x1, y1, z1 */
+		void lines(const Matrix & viewport_T, std::vector<double> & out) const;
+		void outlines(const Matrix & viewport_T, std::vector<double> & out) const;
+
+		/* Appends the points of every filled polygon, through viewport_T, as
+		 * x, y, z to points, and where each polygon ends in points to ends */
+		void polygons(const Matrix & viewport_T, std::vector<double> & points, std::vector<size_t> & ends) const;
+
+	private:
+		enum class Command : unsigned char
+		{
+			Move,
+			Line,
+			Close
+		};
+
+		struct Path
+		{
+			std::vector<Command> commands;
+			std::vector<double> coordinates; //!< x, y pairs of Move and Line commands
+			std::vector<double> depths;      //!< z of the same points
+		};
+
+		//! x' = xx x + xy y + x0, y' = yx x + yy y + y0: all viewport_T does to 2D
+		struct Affine
+		{
+			explicit Affine(const Matrix & M);
+
+			double xx, xy, x0;
+			double yx, yy, y0;
+		};
+
+		void draw_fills(const Cairo::RefPtr<Cairo::Context>& cr, const Matrix & viewport_T) const;
+		void draw_strokes(const Cairo::RefPtr<Cairo::Context>& cr, const Matrix & viewport_T) const;
+
+		/* Appends path, through T, to the current path of cr in one call */
+		static void append(const Cairo::RefPtr<Cairo::Context>& cr, const Path & path, const Affine & T);
+
+		//! Reverses the points [from, to) of _strokes if they wind clockwise
+		void counterclockwise(size_t from, size_t to);
+
+		//! Calls f(x0, y0, z0, x1, y1, z1) for each segment of path through T, closing ones included
+		template<typename F>
+		static void walk(const Path & path, const Affine & T, const F & f);
+
+		Path _strokes;
+		Path _fills;
+
+		//! Where the path the next fill() takes starts in _strokes
+		size_t _commands{0};
+		size_t _coordinates{0};
+	};
+
+/*================================================================================*/
+/*                                 Implementaions                                 */
+/*================================================================================*/
+
+	Frame::Affine::Affine(const Matrix & M) :
+		xx(M[0][0]), xy(M[1][0]), x0(M[3][0]),
+		yx(M[0][1]), yy(M[1][1]), y0(M[3][1])
+	{
+	}
+
+	void Frame::move_to(const Vector & v)
+	{
+		_strokes.commands.push_back(Command::Move);
+		_strokes.coordinates.push_back(v[0]);
+		_strokes.coordinates.push_back(v[1]);
+		_strokes.depths.push_back(v[2]);
+	}
+
+	void Frame::line_to(const Vector & v)
+	{
+		_strokes.commands.push_back(Command::Line);
+		_strokes.coordinates.push_back(v[0]);
+		_strokes.coordinates.push_back(v[1]);
+		_strokes.depths.push_back(v[2]);
+	}
+
+	void Frame::close_path()
+	{
+		_strokes.commands.push_back(Command::Close);
+	}
+
+	void Frame::fill()
+	{
+		/* All fills are one nonzero path: wound alike, overlaps add up instead of cancelling out */
+		for (size_t i = _commands, point = _coordinates / 2; i < _strokes.commands.size();)
+		{
+			const size_t from = point;
+
+			do
+				if (_strokes.commands[i++] != Command::Close)
+					++point;
+			while (i < _strokes.commands.size() && _strokes.commands[i] != Command::Move);
+
+			counterclockwise(from, point);
+		}
+
+		_fills.commands.insert(_fills.commands.end(), _strokes.commands.begin() + _commands, _strokes.commands.end());
+		_fills.coordinates.insert(_fills.coordinates.end(), _strokes.coordinates.begin() + _coordinates, _strokes.coordinates.end());
+		_fills.depths.insert(_fills.depths.end(), _strokes.depths.begin() + _coordinates / 2, _strokes.depths.end());
+
+		/* Outlined with the fills, not among the strokes */
+		_strokes.commands.resize(_commands);
+		_strokes.coordinates.resize(_coordinates);
+		_strokes.depths.resize(_coordinates / 2);
+	}
+
+	void Frame::stroke()
+	{
+		_commands = _strokes.commands.size();
+		_coordinates = _strokes.coordinates.size();
+	}
+
+	void Frame::clear()
+	{
+		for (Path * path : {&_strokes, &_fills})
+		{
+			path->commands.clear();
+			path->coordinates.clear();
+			path->depths.clear();
+		}
+
+		_commands = 0;
+		_coordinates = 0;
+	}
+
+	bool Frame::empty() const
+	{
+		return _strokes.commands.empty() && _fills.commands.empty();
+	}
+
+	size_t Frame::points() const
+	{
+		return (_strokes.coordinates.size() + _fills.coordinates.size()) / 2;
+	}
+
+	size_t Frame::segments() const
+	{
+		return std::count(_strokes.commands.begin(), _strokes.commands.end(), Command::Line)
+		     + std::count(_fills.commands.begin(), _fills.commands.end(), Command::Line);
+	}
+
+	void Frame::draw(const Cairo::RefPtr<Cairo::Context>& cr, const Matrix & viewport_T) const
+	{
+		draw_fills(cr, viewport_T);
+		draw_strokes(cr, viewport_T);
+	}
+
+	void Frame::draw_fills(const Cairo::RefPtr<Cairo::Context>& cr, const Matrix & viewport_T) const
+	{
+		if (_fills.commands.empty())
+			return;
+
+		cr->save();
+		cr->set_source_rgb(0.5, 0.5, 0.5);
+		append(cr, _fills, Affine(viewport_T));
+		cr->fill_preserve();
+		cr->restore();
+
+		/* The path outlives restore() */
+		cr->stroke();
+	}
+
+	void Frame::draw_strokes(const Cairo::RefPtr<Cairo::Context>& cr, const Matrix & viewport_T) const
+	{
+		if (_strokes.commands.empty())
+			return;
+
+		append(cr, _strokes, Affine(viewport_T));
+		cr->stroke();
+	}
+
+	void Frame::lines(const Matrix & viewport_T, std::vector<double> & out) const
+	{
+		out.reserve(out.size() + 2 * _strokes.coordinates.size());
+
+		walk(_strokes, Affine(viewport_T), [&](double x0, double y0, double, double x1, double y1, double) {
+			for (double c : {x0, y0, x1, y1})
+				out.push_back(c);
+		});
+	}
+
+	void Frame::outlines(const Matrix & viewport_T, std::vector<double> & out) const
+	{
+		out.reserve(out.size() + 3 * _fills.coordinates.size());
+
+		walk(_fills, Affine(viewport_T), [&](double x0, double y0, double z0, double x1, double y1, double z1) {
+			for (double c : {x0, y0, z0, x1, y1, z1})
+				out.push_back(c);
+		});
+	}
+
+	void Frame::polygons(const Matrix & viewport_T, std::vector<double> & points, std::vector<size_t> & ends) const
+	{
+		const Affine T(viewport_T);
+		const double * c = _fills.coordinates.data();
+		const double * z = _fills.depths.data();
+
+		points.reserve(points.size() + 3 * _fills.depths.size());
+
+		for (auto command : _fills.commands)
+		{
+			if (command == Command::Close)
+				continue;
+
+			//! Each subpath is a polygon of its own
+			if (command == Command::Move && points.size() / 3 != (ends.empty() ? 0 : ends.back()))
+				ends.push_back(points.size() / 3);
+
+			points.push_back(T.xx * c[0] + T.xy * c[1] + T.x0);
+			points.push_back(T.yx * c[0] + T.yy * c[1] + T.y0);
+			points.push_back(*z);
+
+			c += 2;
+			++z;
+		}
+
+		if (points.size() / 3 != (ends.empty() ? 0 : ends.back()))
+			ends.push_back(points.size() / 3);
+	}
+
+	void Frame::append(const Cairo::RefPtr<Cairo::Context>& cr, const Path & path, const Affine & T)
+	{
+		/* A header per command, then a point for Move and Line */
+		std::vector<cairo_path_data_t> data(path.commands.size() + path.coordinates.size() / 2);
+
+		cairo_path_data_t * d = data.data();
+		const double * c = path.coordinates.data();
+
+		for (auto command : path.commands)
+		{
+			if (command == Command::Close)
+			{
+				d->header.type = CAIRO_PATH_CLOSE_PATH;
+				d->header.length = 1;
+				++d;
+				continue;
+			}
+
+			d[0].header.type = command == Command::Move ? CAIRO_PATH_MOVE_TO : CAIRO_PATH_LINE_TO;
+			d[0].header.length = 2;
+			d[1].point.x = T.xx * c[0] + T.xy * c[1] + T.x0;
+			d[1].point.y = T.yx * c[0] + T.yy * c[1] + T.y0;
+
+			d += 2;
+			c += 2;
+		}
+
+		cairo_path_t cairo_path{CAIRO_STATUS_SUCCESS, data.data(), int(data.size())};
+		cairo_append_path(cr->cobj(), &cairo_path);
+	}
+
+	void Frame::counterclockwise(size_t from, size_t to)
+	{
+		double * c = _strokes.coordinates.data();
+		double area = 0;
+
+		for (size_t i = from, j = to - 1; i < to; j = i++)
+			area += c[2*j] * c[2*i + 1] - c[2*i] * c[2*j + 1];
+
+		if (area >= 0)
+			return;
+
+		for (size_t i = from, j = to - 1; i < j; ++i, --j)
+		{
+			std::swap(c[2*i], c[2*j]);
+			std::swap(c[2*i + 1], c[2*j + 1]);
+		}
+
+		std::reverse(_strokes.depths.begin() + from, _strokes.depths.begin() + to);
+	}
+
+	template<typename F>
+	void Frame::walk(const Path & path, const Affine & T, const F & f)
+	{
+		const double * c = path.coordinates.data();
+		const double * d = path.depths.data();
+
+		/* Current point, and the start of its subpath where Close goes back */
+		double x = 0, y = 0, z = 0, x0 = 0, y0 = 0, z0 = 0;
+
+		for (auto command : path.commands)
+		{
+			double nx = x0, ny = y0, nz = z0;
+
+			if (command != Command::Close)
+			{
+				nx = T.xx * c[0] + T.xy * c[1] + T.x0;
+				ny = T.yx * c[0] + T.yy * c[1] + T.y0;
+				nz = *d++;
+				c += 2;
+			}
+
+			if (command == Command::Move)
+			{
+				x0 = nx;
+				y0 = ny;
+				z0 = nz;
+			}
+			else
+				f(x, y, z, nx, ny, nz);
+
+			x = nx;
+			y = ny;
+			z = nz;
+		}
+	}
+
+} //! namespace model
+
+#endif  // MODEL_FRAME_HPP
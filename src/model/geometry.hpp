@@ -25,7 +25,10 @@
 #define MODEL_GEOMETRY_HPP
 
 /* External includes */
+#include <array>
+#include <cmath>
 #include <vector>
+#include <type_traits>
 
 /* Local includes */
 #include "../config/traits.hpp"
@@ -52,22 +55,15 @@ namespace model
 		const static int dimension = Traits<Vector>::dimension;
 
 		Vector() :
-			_coordinates{x, y, z, w}
+			_coordinates{{x, y, z, w}}
 		{
 		}
 
-		Vector(const Vector& v) :
-			_coordinates{v._coordinates}
-		{
-		}
-
-		Vector(Vector&& v) :
-			_coordinates{v._coordinates}
-		{
-		}
+		Vector(const Vector& v) = default;
+		Vector(Vector&& v) = default;
 
 		Vector(double x0, double y0, double z0 = z, double w0 = w) :
-			_coordinates{x0, y0, z0, w0}
+			_coordinates{{x0, y0, z0, w0}}
 		{
 		}
 
@@ -108,7 +104,8 @@ namespace model
 		}
 
 	private:
-		std::vector<double> _coordinates;
+		//! Inline storage: no heap allocation per temporary
+		std::array<double, dimension> _coordinates;
 	};
 
 /*--------------------------------------------------------------------------------*/
@@ -128,7 +125,7 @@ namespace model
 			   const MatrixLine& l1 = {0, 1, 0, 0},
 			   const MatrixLine& l2 = {0, 0, 1, 0},
 			   const MatrixLine& l3 = {0, 0, 0, 1}) :
-			_vectors{l0, l1, l2, l3}
+			_vectors{{l0, l1, l2, l3}}
 		{
 		}
 
@@ -136,10 +133,16 @@ namespace model
 			   MatrixLine&& l1,
 			   MatrixLine&& l2,
 			   MatrixLine&& l3) :
-			_vectors{l0, l1, l2, l3}
+			_vectors{{l0, l1, l2, l3}}
 		{
 		}
 
+		Matrix(const Matrix& M) = default;
+		Matrix(Matrix&& M) = default;
+
+		Matrix &operator=(const Matrix &) = default;
+		Matrix &operator=(Matrix &&) = default;
+
 		~Matrix() = default;
 
 		Matrix transpose() const;
@@ -164,9 +167,12 @@ namespace model
 		}
 
 	private:
-		std::vector<MatrixLine> _vectors;
+		std::array<MatrixLine, dimension> _vectors;
 	};
 
+	static_assert(std::is_trivially_copyable<Vector>::value, "Vector must be trivially copyable");
+	static_assert(std::is_trivially_copyable<Matrix>::value, "Matrix must be trivially copyable");
+
 /*--------------------------------------------------------------------------------*/
 /*                                calculation                                 */
 /*--------------------------------------------------------------------------------*/
@@ -259,7 +265,7 @@ namespace model
 
 	const double& Vector::operator[](const int position) const
 	{
-		return _coordinates.at(position);
+		return _coordinates[position];
 	}
 
 	Vector Vector::operator+(const Vector& v) const
@@ -302,7 +308,7 @@ namespace model
 		Vector v(0, 0);
 
 		for (int i = 0; i < dimension-1; ++i)
-			v[i] = scalar * _coordinates.at(i);
+			v[i] = scalar * _coordinates[i];
 
 		return v;
 	}
@@ -319,7 +325,7 @@ namespace model
 
 		for (int j = 0; j < dimension; ++j)
 			for (int i = 0; i < dimension; ++i)
-				v[j] += _coordinates.at(i) * M[i][j];
+				v[j] += _coordinates[i] * M[i][j];
 
 		return v;
 	}
@@ -361,7 +367,7 @@ namespace model
 
 		for (int j = 0; j < D; ++j)
 			for (int i = 0; i < D; ++i)
-				v[j] += _coordinates.at(i) * M[i][j];
+				v[j] += _coordinates[i] * M[i][j];
 
 		return v;
 	}
@@ -387,7 +393,7 @@ namespace model
 
 	const Matrix::MatrixLine& Matrix::operator[](const int position) const
 	{
-		return _vectors.at(position);
+		return _vectors[position];
 	}
 
 	std::vector<double> Matrix::operator*(const std::vector<double>& v) const
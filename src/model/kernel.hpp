@@ -0,0 +1,478 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MODEL_KERNEL_HPP
+#define MODEL_KERNEL_HPP
+
+/* External includes */
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MODEL_KERNEL_X86
+#endif
+
+/* Local includes */
+#include "../config/traits.hpp"
+#include "geometry.hpp"
+
+namespace model
+{
+
+/*================================================================================*/
+/*                                   Definitions                                  */
+/*================================================================================*/
+
+	static_assert(sizeof(Vector) == Vector::dimension * sizeof(double), "Vector must be packed");
+
+	namespace kernel
+	{
+		/* Transforms n packed {x, y, z, w} vectors by M. In and out may alias. */
+		void transform_points(const Matrix & M, const double * in, double * out, size_t n);
+
+		void transform_points(const Matrix & M, const std::vector<Vector> & in, std::vector<Vector> & out);
+		void transform_points(const Matrix & M, std::vector<Vector> & vectors);
+
+		/* Same, with vectors stored as separate x[], y[], z[] and w[] arrays. */
+		void transform_soa(const Matrix & M, const double * const in[4], double * const out[4], size_t n);
+
+		/* Liang-Barsky on n segments stored as x0[], y0[], x1[], y1[] against
+		 * box = {xmin, ymin, xmax, ymax}. The visible parts are packed at the
+		 * front of out, the index of their segment in kept. Returns how many
+		 * survive. In and out may alias. */
+		size_t clip_segments(const double * const in[4], size_t n, const double box[4], double * const out[4], unsigned * kept);
+
+		/* Name of the kernel picked at runtime */
+		const char * name();
+
+		/* Anonymous namespace: This does not export the following features */
+		namespace
+		{
+			using Function = void (*)(const Matrix &, const double *, double *, size_t);
+			using SoAFunction = void (*)(const Matrix &, const double * const *, double * const *, size_t);
+			using ClipFunction = size_t (*)(const double * const *, size_t, const double *, double * const *, unsigned *);
+
+			struct Kernel
+			{
+				const char * name;
+				Function function;
+				SoAFunction soa;
+				ClipFunction clip;
+			};
+
+			void scalar_soa(const Matrix & M, const double * const in[4], double * const out[4], size_t begin, size_t end)
+			{
+				for (size_t k = begin; k < end; ++k)
+				{
+					const double x = in[0][k], y = in[1][k], z = in[2][k], w = in[3][k];
+
+					for (int j = 0; j < 4; ++j)
+						out[j][k] = x * M[0][j] + y * M[1][j] + z * M[2][j] + w * M[3][j];
+				}
+			}
+
+			void scalar_soa(const Matrix & M, const double * const in[4], double * const out[4], size_t n)
+			{
+				scalar_soa(M, in, out, 0, n);
+			}
+
+			//! Clips segments [begin, end), packing survivors from out[count]
+			size_t scalar_clip(const double * const in[4], size_t begin, size_t end, const double box[4],
+			                   double * const out[4], unsigned * kept, size_t count)
+			{
+				for (size_t k = begin; k < end; ++k)
+				{
+					const double x0 = in[0][k], y0 = in[1][k];
+					const double dx = in[2][k] - x0, dy = in[3][k] - y0;
+
+					const double q1 = x0 - box[0], q2 = box[2] - x0;
+					const double q3 = y0 - box[1], q4 = box[3] - y0;
+
+					double t0 = 0, t1 = 1;
+
+					/* Parallel to an edge: outside unless between both of its planes */
+					if (dx == 0)
+					{
+						if (q1 < 0 || q2 < 0)
+							continue;
+					}
+					else
+					{
+						const double r1 = q1 / -dx, r2 = q2 / dx;
+						const double enter = dx > 0 ? r1 : r2, leave = dx > 0 ? r2 : r1;
+
+						t0 = enter > t0 ? enter : t0;
+						t1 = leave < t1 ? leave : t1;
+					}
+
+					if (dy == 0)
+					{
+						if (q3 < 0 || q4 < 0)
+							continue;
+					}
+					else
+					{
+						const double r3 = q3 / -dy, r4 = q4 / dy;
+						const double enter = dy > 0 ? r3 : r4, leave = dy > 0 ? r4 : r3;
+
+						t0 = enter > t0 ? enter : t0;
+						t1 = leave < t1 ? leave : t1;
+					}
+
+					if (t0 > t1)
+						continue;
+
+					out[0][count] = x0 + dx * t0;
+					out[1][count] = y0 + dy * t0;
+					out[2][count] = x0 + dx * t1;
+					out[3][count] = y0 + dy * t1;
+					kept[count++] = k;
+				}
+
+				return count;
+			}
+
+			size_t scalar_clip(const double * const in[4], size_t n, const double box[4], double * const out[4], unsigned * kept)
+			{
+				return scalar_clip(in, 0, n, box, out, kept, 0);
+			}
+
+			void scalar(const Matrix & M, const double * in, double * out, size_t n)
+			{
+				for (size_t k = 0; k < n; ++k, in += 4, out += 4)
+				{
+					const double x = in[0], y = in[1], z = in[2], w = in[3];
+
+					for (int j = 0; j < 4; ++j)
+						out[j] = x * M[0][j] + y * M[1][j] + z * M[2][j] + w * M[3][j];
+				}
+			}
+
+#ifdef MODEL_KERNEL_X86
+			void sse2(const Matrix & M, const double * in, double * out, size_t n)
+			{
+				const __m128d r0l = _mm_loadu_pd(&M[0][0]), r0h = _mm_loadu_pd(&M[0][2]);
+				const __m128d r1l = _mm_loadu_pd(&M[1][0]), r1h = _mm_loadu_pd(&M[1][2]);
+				const __m128d r2l = _mm_loadu_pd(&M[2][0]), r2h = _mm_loadu_pd(&M[2][2]);
+				const __m128d r3l = _mm_loadu_pd(&M[3][0]), r3h = _mm_loadu_pd(&M[3][2]);
+
+				for (size_t k = 0; k < n; ++k, in += 4, out += 4)
+				{
+					const __m128d x = _mm_set1_pd(in[0]);
+					const __m128d y = _mm_set1_pd(in[1]);
+					const __m128d z = _mm_set1_pd(in[2]);
+					const __m128d w = _mm_set1_pd(in[3]);
+
+					__m128d l = _mm_mul_pd(x, r0l);
+					__m128d h = _mm_mul_pd(x, r0h);
+
+					l = _mm_add_pd(l, _mm_mul_pd(y, r1l));
+					h = _mm_add_pd(h, _mm_mul_pd(y, r1h));
+					l = _mm_add_pd(l, _mm_mul_pd(z, r2l));
+					h = _mm_add_pd(h, _mm_mul_pd(z, r2h));
+					l = _mm_add_pd(l, _mm_mul_pd(w, r3l));
+					h = _mm_add_pd(h, _mm_mul_pd(w, r3h));
+
+					_mm_storeu_pd(out, l);
+					_mm_storeu_pd(out + 2, h);
+				}
+			}
+
+			void sse2_soa(const Matrix & M, const double * const in[4], double * const out[4], size_t n)
+			{
+				size_t k = 0;
+
+				for (; k + 2 <= n; k += 2)
+				{
+					const __m128d x = _mm_loadu_pd(in[0] + k);
+					const __m128d y = _mm_loadu_pd(in[1] + k);
+					const __m128d z = _mm_loadu_pd(in[2] + k);
+					const __m128d w = _mm_loadu_pd(in[3] + k);
+
+					__m128d r[4];
+
+					for (int j = 0; j < 4; ++j)
+					{
+						r[j] = _mm_mul_pd(x, _mm_set1_pd(M[0][j]));
+						r[j] = _mm_add_pd(r[j], _mm_mul_pd(y, _mm_set1_pd(M[1][j])));
+						r[j] = _mm_add_pd(r[j], _mm_mul_pd(z, _mm_set1_pd(M[2][j])));
+						r[j] = _mm_add_pd(r[j], _mm_mul_pd(w, _mm_set1_pd(M[3][j])));
+					}
+
+					for (int j = 0; j < 4; ++j)
+						_mm_storeu_pd(out[j] + k, r[j]);
+				}
+
+				scalar_soa(M, in, out, k, n);
+			}
+
+			/* Same operations as scalar_clip, two segments at a time. Dividing
+			 * by a zero delta is harmless: its lanes take the parallel case. */
+			size_t sse2_clip(const double * const in[4], size_t n, const double box[4], double * const out[4], unsigned * kept)
+			{
+				const __m128d zero = _mm_setzero_pd(), one = _mm_set1_pd(1);
+				const __m128d xmin = _mm_set1_pd(box[0]), ymin = _mm_set1_pd(box[1]);
+				const __m128d xmax = _mm_set1_pd(box[2]), ymax = _mm_set1_pd(box[3]);
+
+				size_t k = 0, count = 0;
+
+				for (; k + 2 <= n; k += 2)
+				{
+					const __m128d x0 = _mm_loadu_pd(in[0] + k), y0 = _mm_loadu_pd(in[1] + k);
+					const __m128d dx = _mm_sub_pd(_mm_loadu_pd(in[2] + k), x0);
+					const __m128d dy = _mm_sub_pd(_mm_loadu_pd(in[3] + k), y0);
+
+					const __m128d q1 = _mm_sub_pd(x0, xmin), q2 = _mm_sub_pd(xmax, x0);
+					const __m128d q3 = _mm_sub_pd(y0, ymin), q4 = _mm_sub_pd(ymax, y0);
+
+					const __m128d flat_x = _mm_cmpeq_pd(dx, zero), flat_y = _mm_cmpeq_pd(dy, zero);
+					const __m128d rising_x = _mm_cmpgt_pd(dx, zero), rising_y = _mm_cmpgt_pd(dy, zero);
+
+					const __m128d r1 = _mm_div_pd(q1, _mm_sub_pd(zero, dx)), r2 = _mm_div_pd(q2, dx);
+					const __m128d r3 = _mm_div_pd(q3, _mm_sub_pd(zero, dy)), r4 = _mm_div_pd(q4, dy);
+
+					//! blend(a, b, mask): b where mask is set
+					auto blend = [](__m128d a, __m128d b, __m128d mask) {
+						return _mm_or_pd(_mm_andnot_pd(mask, a), _mm_and_pd(mask, b));
+					};
+
+					__m128d t0 = zero, t1 = one;
+
+					t0 = blend(_mm_max_pd(blend(r2, r1, rising_x), t0), t0, flat_x);
+					t1 = blend(_mm_min_pd(blend(r1, r2, rising_x), t1), t1, flat_x);
+					t0 = blend(_mm_max_pd(blend(r4, r3, rising_y), t0), t0, flat_y);
+					t1 = blend(_mm_min_pd(blend(r3, r4, rising_y), t1), t1, flat_y);
+
+					const __m128d outside_x = _mm_and_pd(flat_x, _mm_or_pd(_mm_cmplt_pd(q1, zero), _mm_cmplt_pd(q2, zero)));
+					const __m128d outside_y = _mm_and_pd(flat_y, _mm_or_pd(_mm_cmplt_pd(q3, zero), _mm_cmplt_pd(q4, zero)));
+					const __m128d rejected = _mm_or_pd(_mm_or_pd(outside_x, outside_y), _mm_cmpgt_pd(t0, t1));
+
+					int mask = ~_mm_movemask_pd(rejected) & 0x3;
+
+					if (!mask)
+						continue;
+
+					double r[4][2];
+
+					_mm_storeu_pd(r[0], _mm_add_pd(x0, _mm_mul_pd(dx, t0)));
+					_mm_storeu_pd(r[1], _mm_add_pd(y0, _mm_mul_pd(dy, t0)));
+					_mm_storeu_pd(r[2], _mm_add_pd(x0, _mm_mul_pd(dx, t1)));
+					_mm_storeu_pd(r[3], _mm_add_pd(y0, _mm_mul_pd(dy, t1)));
+
+					for (int lane = 0; lane < 2; ++lane)
+					{
+						if (!(mask & 1 << lane))
+							continue;
+
+						for (int j = 0; j < 4; ++j)
+							out[j][count] = r[j][lane];
+
+						kept[count++] = k + lane;
+					}
+				}
+
+				return scalar_clip(in, k, n, box, out, kept, count);
+			}
+
+			//! No FMA: keeps results bit-identical to the scalar kernel
+			__attribute__((target("avx")))
+			void avx(const Matrix & M, const double * in, double * out, size_t n)
+			{
+				const __m256d r0 = _mm256_loadu_pd(&M[0][0]);
+				const __m256d r1 = _mm256_loadu_pd(&M[1][0]);
+				const __m256d r2 = _mm256_loadu_pd(&M[2][0]);
+				const __m256d r3 = _mm256_loadu_pd(&M[3][0]);
+
+				for (size_t k = 0; k < n; ++k, in += 4, out += 4)
+				{
+					__m256d v = _mm256_mul_pd(_mm256_broadcast_sd(in), r0);
+
+					v = _mm256_add_pd(v, _mm256_mul_pd(_mm256_broadcast_sd(in + 1), r1));
+					v = _mm256_add_pd(v, _mm256_mul_pd(_mm256_broadcast_sd(in + 2), r2));
+					v = _mm256_add_pd(v, _mm256_mul_pd(_mm256_broadcast_sd(in + 3), r3));
+
+					_mm256_storeu_pd(out, v);
+				}
+			}
+
+			__attribute__((target("avx")))
+			void avx_soa(const Matrix & M, const double * const in[4], double * const out[4], size_t n)
+			{
+				size_t k = 0;
+
+				for (; k + 4 <= n; k += 4)
+				{
+					const __m256d x = _mm256_loadu_pd(in[0] + k);
+					const __m256d y = _mm256_loadu_pd(in[1] + k);
+					const __m256d z = _mm256_loadu_pd(in[2] + k);
+					const __m256d w = _mm256_loadu_pd(in[3] + k);
+
+					__m256d r[4];
+
+					for (int j = 0; j < 4; ++j)
+					{
+						r[j] = _mm256_mul_pd(x, _mm256_set1_pd(M[0][j]));
+						r[j] = _mm256_add_pd(r[j], _mm256_mul_pd(y, _mm256_set1_pd(M[1][j])));
+						r[j] = _mm256_add_pd(r[j], _mm256_mul_pd(z, _mm256_set1_pd(M[2][j])));
+						r[j] = _mm256_add_pd(r[j], _mm256_mul_pd(w, _mm256_set1_pd(M[3][j])));
+					}
+
+					for (int j = 0; j < 4; ++j)
+						_mm256_storeu_pd(out[j] + k, r[j]);
+				}
+
+				scalar_soa(M, in, out, k, n);
+			}
+
+			__attribute__((target("avx")))
+			size_t avx_clip(const double * const in[4], size_t n, const double box[4], double * const out[4], unsigned * kept)
+			{
+				const __m256d zero = _mm256_setzero_pd(), one = _mm256_set1_pd(1);
+				const __m256d xmin = _mm256_set1_pd(box[0]), ymin = _mm256_set1_pd(box[1]);
+				const __m256d xmax = _mm256_set1_pd(box[2]), ymax = _mm256_set1_pd(box[3]);
+
+				size_t k = 0, count = 0;
+
+				for (; k + 4 <= n; k += 4)
+				{
+					const __m256d x0 = _mm256_loadu_pd(in[0] + k), y0 = _mm256_loadu_pd(in[1] + k);
+					const __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(in[2] + k), x0);
+					const __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(in[3] + k), y0);
+
+					const __m256d q1 = _mm256_sub_pd(x0, xmin), q2 = _mm256_sub_pd(xmax, x0);
+					const __m256d q3 = _mm256_sub_pd(y0, ymin), q4 = _mm256_sub_pd(ymax, y0);
+
+					const __m256d flat_x = _mm256_cmp_pd(dx, zero, _CMP_EQ_OQ), flat_y = _mm256_cmp_pd(dy, zero, _CMP_EQ_OQ);
+					const __m256d rising_x = _mm256_cmp_pd(dx, zero, _CMP_GT_OQ), rising_y = _mm256_cmp_pd(dy, zero, _CMP_GT_OQ);
+
+					const __m256d r1 = _mm256_div_pd(q1, _mm256_sub_pd(zero, dx)), r2 = _mm256_div_pd(q2, dx);
+					const __m256d r3 = _mm256_div_pd(q3, _mm256_sub_pd(zero, dy)), r4 = _mm256_div_pd(q4, dy);
+
+					__m256d t0 = zero, t1 = one;
+
+					t0 = _mm256_blendv_pd(_mm256_max_pd(_mm256_blendv_pd(r2, r1, rising_x), t0), t0, flat_x);
+					t1 = _mm256_blendv_pd(_mm256_min_pd(_mm256_blendv_pd(r1, r2, rising_x), t1), t1, flat_x);
+					t0 = _mm256_blendv_pd(_mm256_max_pd(_mm256_blendv_pd(r4, r3, rising_y), t0), t0, flat_y);
+					t1 = _mm256_blendv_pd(_mm256_min_pd(_mm256_blendv_pd(r3, r4, rising_y), t1), t1, flat_y);
+
+					const __m256d outside_x = _mm256_and_pd(flat_x,
+						_mm256_or_pd(_mm256_cmp_pd(q1, zero, _CMP_LT_OQ), _mm256_cmp_pd(q2, zero, _CMP_LT_OQ)));
+					const __m256d outside_y = _mm256_and_pd(flat_y,
+						_mm256_or_pd(_mm256_cmp_pd(q3, zero, _CMP_LT_OQ), _mm256_cmp_pd(q4, zero, _CMP_LT_OQ)));
+					const __m256d rejected = _mm256_or_pd(_mm256_or_pd(outside_x, outside_y), _mm256_cmp_pd(t0, t1, _CMP_GT_OQ));
+
+					int mask = ~_mm256_movemask_pd(rejected) & 0xf;
+
+					if (!mask)
+						continue;
+
+					double r[4][4];
+
+					_mm256_storeu_pd(r[0], _mm256_add_pd(x0, _mm256_mul_pd(dx, t0)));
+					_mm256_storeu_pd(r[1], _mm256_add_pd(y0, _mm256_mul_pd(dy, t0)));
+					_mm256_storeu_pd(r[2], _mm256_add_pd(x0, _mm256_mul_pd(dx, t1)));
+					_mm256_storeu_pd(r[3], _mm256_add_pd(y0, _mm256_mul_pd(dy, t1)));
+
+					for (int lane = 0; lane < 4; ++lane)
+					{
+						if (!(mask & 1 << lane))
+							continue;
+
+						for (int j = 0; j < 4; ++j)
+							out[j][count] = r[j][lane];
+
+						kept[count++] = k + lane;
+					}
+				}
+
+				return scalar_clip(in, k, n, box, out, kept, count);
+			}
+#endif
+
+			Kernel select()
+			{
+				if (Traits<Matrix>::vectorized)
+				{
+#ifdef MODEL_KERNEL_X86
+					__builtin_cpu_init();
+
+					if (__builtin_cpu_supports("avx"))
+						return {"avx", avx, avx_soa, avx_clip};
+
+					if (__builtin_cpu_supports("sse2"))
+						return {"sse2", sse2, sse2_soa, sse2_clip};
+#endif
+				}
+
+				return {"scalar", scalar, scalar_soa, scalar_clip};
+			}
+
+			const Kernel & selected()
+			{
+				static const Kernel k = select();
+				return k;
+			}
+		}
+	} //! namespace kernel
+
+/*================================================================================*/
+/*                                 Implementaions                                 */
+/*================================================================================*/
+
+	void kernel::transform_points(const Matrix & M, const double * in, double * out, size_t n)
+	{
+		selected().function(M, in, out, n);
+	}
+
+	void kernel::transform_points(const Matrix & M, const std::vector<Vector> & in, std::vector<Vector> & out)
+	{
+		out.resize(in.size());
+
+		if (!in.empty())
+			transform_points(M, &in[0][0], &out[0][0], in.size());
+	}
+
+	void kernel::transform_points(const Matrix & M, std::vector<Vector> & vectors)
+	{
+		if (!vectors.empty())
+			transform_points(M, &vectors[0][0], &vectors[0][0], vectors.size());
+	}
+
+	void kernel::transform_soa(const Matrix & M, const double * const in[4], double * const out[4], size_t n)
+	{
+		selected().soa(M, in, out, n);
+	}
+
+	size_t kernel::clip_segments(const double * const in[4], size_t n, const double box[4], double * const out[4], unsigned * kept)
+	{
+		return selected().clip(in, n, box, out, kept);
+	}
+
+	const char * kernel::name()
+	{
+		return selected().name;
+	}
+
+} //! namespace model
+
+#endif  // MODEL_KERNEL_HPP
@@ -28,6 +28,7 @@
 
 /* Local includes */
 #include "../config/traits.hpp"
+#include "kernel.hpp"
 #include "shape.hpp"
 
 namespace model
@@ -52,6 +53,10 @@ namespace model
 			Shape(name, {world_v1, world_v2})
 		{}
 
+		Line(std::string name, const std::shared_ptr<VertexBuffer>& buffer, VertexBuffer::Index i1, VertexBuffer::Index i2) :
+			Shape(name, buffer, {i1, i2})
+		{}
+
 		~Line() = default;
 
 		void clipping(const Vector & min, const Vector & max) override;
@@ -70,7 +75,7 @@ namespace model
 
 	void Line::cohen_sutherland(const Vector & min, const Vector & max)
 	{
-		db<Line>(INF) << "[" << this << "] Cohen Sutherland" << std::endl;
+		DB(Line, INF) << "[" << this << "] Cohen Sutherland" << std::endl;
 
 		enum Region
 		{
@@ -154,74 +159,25 @@ namespace model
 
 	void Line::liang_barsky(const Vector & min, const Vector & max)
 	{
-		db<Line>(INF) << "[" << this << "] Liang Barsky" << std::endl;
-
-		Vector pa = _window_vectors[0];
-		Vector pb = _window_vectors[1];
-
-		double p4 = pb[1] - pa[1];
-		double p3 = -p4;
-		double p2 = pb[0] - pa[0];
-		double p1 = -p2;
-
-		double q1 = pa[0] - min[0];
-		double q2 = max[0] - pa[0];
-		double q3 = pa[1] - min[1];
-		double q4 = max[1] - pa[1];
-
-		double positive[5], negative[5];
-
-		int pos_index = 1, neg_index = 1;
-
-		positive[0] = 1;
-		negative[0] = 0;
-
-		if ((p1 == 0 && q1 < 0) || (p3 == 0 && q3 < 0))
-		{
-			_window_vectors.clear();
-			return;
-		}
-
-		if (p1 != 0)
-		{
-			double r1 = q1 / p1;
-			double r2 = q2 / p2;
-
-			negative[neg_index++] = p1 < 0 ? r1 : r2;
-			positive[pos_index++] = p1 < 0 ? r2 : r1;
-		}
-
-		if (p3 != 0)
-		{
-			double r3 = q3 / p3;
-			double r4 = q4 / p4;
-
-			negative[neg_index++] = p3 < 0 ? r3: r4;
-			positive[pos_index++] = p3 < 0 ? r4: r3;
-		}
-
-		double rn1 = negative[0];
-		double rn2 = positive[0];
-
-		for (int i = 1; i < neg_index; ++i)
-			if (rn1 < negative[i])
-				rn1 = negative[i];
+		DB(Line, INF) << "[" << this << "] Liang Barsky" << std::endl;
 
-		for (int i = 1; i < pos_index; ++i)
-			if (rn2 > positive[i])
-				rn2 = positive[i];
+		const double box[4] = {min[0], min[1], max[0], max[1]};
+		double x0 = _window_vectors[0][0], y0 = _window_vectors[0][1];
+		double x1 = _window_vectors[1][0], y1 = _window_vectors[1][1];
+		double * const segment[4] = {&x0, &y0, &x1, &y1};
+		unsigned kept;
 
-		if (rn1 > rn2)
+		if (!kernel::clip_segments(segment, 1, box, segment, &kept))
 		{
 			_window_vectors.clear();
 			return;
 		}
 
-		_window_vectors[0][0] = pa[0] + p2 * rn1;
-		_window_vectors[0][1] = pa[1] + p4 * rn1;
+		_window_vectors[0][0] = x0;
+		_window_vectors[0][1] = y0;
 
-		_window_vectors[1][0] = pa[0] + p2 * rn2;
-		_window_vectors[1][1] = pa[1] + p4 * rn2;
+		_window_vectors[1][0] = x1;
+		_window_vectors[1][1] = y1;
 	}
 
 	void Line::clipping(const Vector & min, const Vector & max)
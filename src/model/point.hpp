@@ -49,6 +49,10 @@ namespace model
 			Shape(name, Vector(x, y, z, w))
 		{}
 
+		Point(std::string name, const std::shared_ptr<VertexBuffer>& buffer, VertexBuffer::Index i) :
+			Shape(name, buffer, {i})
+		{}
+
 		~Point() = default;
 
 		void clipping(const Vector & min, const Vector & max) override;
@@ -61,7 +65,7 @@ namespace model
 
 	void Point::clipping(const Vector & min, const Vector & max)
 	{
-		db<Point>(INF) << "[" << this << "] Clipping Point" << std::endl;
+		DB(Point, INF) << "[" << this << "] Clipping Point" << std::endl;
 
 		Vector & p = _window_vectors[0];
 
@@ -28,6 +28,7 @@
 
 /* Local includes */
 #include "../config/traits.hpp"
+#include "../sys/statistics.hpp"
 #include "shape.hpp"
 
 namespace model
@@ -40,6 +41,12 @@ namespace model
 	class Polygon : public Shape
 	{
 	public:
+		/* Faces of loaded models (the polygons indexing a VertexBuffer) that
+		 * turn clockwise on screen face away from the eye, as OBJ lists the
+		 * vertices of a face counterclockwise seen from the front: neither
+		 * clipped nor drawn. Read while building: invalidate shapes on change. */
+		static bool back_face_culling;
+
 		Polygon(std::string name, const std::initializer_list<Vector>& vs, bool filled = false) :
 			Shape(name, vs, true),
 			_filled(filled)
@@ -50,23 +57,39 @@ namespace model
 			_filled(filled)
 		{}
 
+		Polygon(std::string name,
+				const std::shared_ptr<VertexBuffer>& buffer,
+				const std::vector<VertexBuffer::Index>& indices,
+				bool filled = false) :
+			Shape(name, buffer, indices, true),
+			_filled(filled)
+		{}
+
 		~Polygon() = default;
 
-		void draw(const Cairo::RefPtr<Cairo::Context>& cr, const Matrix & viewport_T) override;
+		void draw(Frame & frame) override;
+		void facing() override;
 		void clipping(const Vector & min, const Vector & max) override;
 
 		std::string type() override;
+		bool filled() const;
 
 	private:
 		void sutherland_hodgeman(double x1, double y1, double x2, double y2);
 
+		//! Its window vectors turn clockwise
+		bool back_facing() const;
+
 		bool _filled{false};
+		bool _back_facing{false};  //!< Culled as such at the last build
 	};
 
 /*================================================================================*/
 /*                                 Implementaions                                 */
 /*================================================================================*/
 
+	bool Polygon::back_face_culling{false};
+
 	void Polygon::sutherland_hodgeman(double x1, double y1, double x2, double y2)
 	{
 		std::vector<Vector> new_vectors;
@@ -91,41 +114,63 @@ namespace model
 			return num / den;
 		};
 
+		//! The intersection with the edge from i to k, its depth interpolated
+		auto intersection = [&](const Vector & i, const Vector & k, double i_pos, double k_pos)
+		{
+			const double t = i_pos / (i_pos - k_pos);
+
+			return Vector(
+				x_intersect(i[0], i[1], k[0], k[1]),
+				y_intersect(i[0], i[1], k[0], k[1]),
+				i[2] + (k[2] - i[2]) * t
+			);
+		};
+
 		for (size_t i = 0, k = 1; i < _window_vectors.size(); i++, k = (k + 1) % _window_vectors.size())
 		{
-			double ix = _window_vectors[i][0], iy = _window_vectors[i][1];
-			double kx = _window_vectors[k][0], ky = _window_vectors[k][1];
+			const Vector & vi = _window_vectors[i];
+			const Vector & vk = _window_vectors[k];
 
-			double i_pos = (x2 - x1) * (iy - y1) - (y2 - y1) * (ix - x1);
-			double k_pos = (x2 - x1) * (ky - y1) - (y2 - y1) * (kx - x1);
+			double i_pos = (x2 - x1) * (vi[1] - y1) - (y2 - y1) * (vi[0] - x1);
+			double k_pos = (x2 - x1) * (vk[1] - y1) - (y2 - y1) * (vk[0] - x1);
 
 			if (i_pos < 0  && k_pos < 0) 
-				new_vectors.emplace_back(kx, ky);
+				new_vectors.push_back(vk);
 
 			else if (i_pos >= 0  && k_pos < 0)
 			{
-				new_vectors.emplace_back(
-					x_intersect(ix, iy, kx, ky),
-					y_intersect(ix, iy, kx, ky)
-				);
-
-				new_vectors.emplace_back(kx, ky);
+				new_vectors.push_back(intersection(vi, vk, i_pos, k_pos));
+				new_vectors.push_back(vk);
 			}
 
 			else if (i_pos < 0  && k_pos >= 0) 
-			{
-				new_vectors.emplace_back(
-					x_intersect(ix, iy, kx, ky),
-					y_intersect(ix, iy, kx, ky)
-				);
-			}
+				new_vectors.push_back(intersection(vi, vk, i_pos, k_pos));
 		}
 
 		_window_vectors = std::move(new_vectors);
 	}
 
+	bool Polygon::back_facing() const
+	{
+		/* Twice the signed area: positive when counterclockwise */
+		double area = 0;
+
+		for (size_t i = 0, j = _window_vectors.size() - 1; i < _window_vectors.size(); j = i++)
+			area += _window_vectors[j][0] * _window_vectors[i][1] - _window_vectors[i][0] * _window_vectors[j][1];
+
+		return area < 0;
+	}
+
+	void Polygon::facing()
+	{
+		_back_facing = back_face_culling && _buffer && back_facing();
+	}
+
 	void Polygon::clipping(const Vector & min, const Vector & max)
 	{
+		if (_back_facing)
+			return;
+
 		double edges[4][2] = {
 			{min[0], min[1]},
 			{min[0], max[1]},
@@ -140,17 +185,30 @@ namespace model
 			);
 	}
 
-	void Polygon::draw(const Cairo::RefPtr<Cairo::Context>& cr, const Matrix & viewport_T)
+	void Polygon::draw(Frame & frame)
 	{
-		Shape::draw(cr, viewport_T);
+		if (_back_facing)
+		{
+			if (Traits<sys::Statistics>::enabled)
+				sys::Statistics::instance().add(sys::Statistics::FACES_CULLED, 1);
+
+			return;
+		}
 
 		if (_filled)
 		{
-			cr->save();
-			cr->set_source_rgb(0.5, 0.5, 0.5);
-			cr->fill_preserve();
-			cr->restore();
+			/* fill() takes only this path, not earlier siblings of a ComplexShape */
+			frame.stroke();
+			Shape::draw(frame);
+			frame.fill();
 		}
+		else
+			Shape::draw(frame);
+	}
+
+	bool Polygon::filled() const
+	{
+		return _filled;
 	}
 
 	std::string Polygon::type()
@@ -0,0 +1,145 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MODEL_POLYLINES_HPP
+#define MODEL_POLYLINES_HPP
+
+/* External includes */
+#include <vector>
+
+/* Local includes */
+#include "geometry.hpp"
+
+namespace model
+{
+
+/*================================================================================*/
+/*                                   Definitions                                  */
+/*================================================================================*/
+
+	/* Polylines back to back in one array of vectors, with the offset each
+	 * starts at: a batch of them is two allocations, not one per polyline */
+	class Polylines
+	{
+	public:
+		Polylines() = default;
+		Polylines(const Polylines &) = default;
+		Polylines(Polylines &&) = default;
+
+		Polylines &operator=(const Polylines &) = default;
+		Polylines &operator=(Polylines &&) = default;
+
+		~Polylines() = default;
+
+		void clear();
+
+		//! count polylines of length vectors each, left to be written
+		void assign(size_t count, size_t length);
+
+		/* Every vector. A polyline is built appending to them, then close() */
+		std::vector<Vector> & vectors();
+		const std::vector<Vector> & vectors() const;
+
+		//! Ends the polyline at the vectors appended so far
+		void close();
+
+		size_t size() const;
+		bool empty() const;
+
+		Vector * begin(size_t line);
+		Vector * end(size_t line);
+		const Vector * begin(size_t line) const;
+		const Vector * end(size_t line) const;
+
+	private:
+		std::vector<Vector> _vectors;
+		std::vector<size_t> _offsets{0};  //!< Line l is [_offsets[l], _offsets[l + 1])
+	};
+
+/*================================================================================*/
+/*                                 Implementaions                                 */
+/*================================================================================*/
+
+	void Polylines::clear()
+	{
+		_vectors.clear();
+		_offsets.assign(1, 0);
+	}
+
+	void Polylines::assign(size_t count, size_t length)
+	{
+		_vectors.resize(count * length);
+		_offsets.resize(count + 1);
+
+		for (size_t l = 0; l <= count; ++l)
+			_offsets[l] = l * length;
+	}
+
+	std::vector<Vector> & Polylines::vectors()
+	{
+		return _vectors;
+	}
+
+	const std::vector<Vector> & Polylines::vectors() const
+	{
+		return _vectors;
+	}
+
+	void Polylines::close()
+	{
+		_offsets.push_back(_vectors.size());
+	}
+
+	size_t Polylines::size() const
+	{
+		return _offsets.size() - 1;
+	}
+
+	bool Polylines::empty() const
+	{
+		return _offsets.size() == 1;
+	}
+
+	Vector * Polylines::begin(size_t line)
+	{
+		return _vectors.data() + _offsets[line];
+	}
+
+	Vector * Polylines::end(size_t line)
+	{
+		return _vectors.data() + _offsets[line + 1];
+	}
+
+	const Vector * Polylines::begin(size_t line) const
+	{
+		return _vectors.data() + _offsets[line];
+	}
+
+	const Vector * Polylines::end(size_t line) const
+	{
+		return _vectors.data() + _offsets[line + 1];
+	}
+
+} //! namespace model
+
+#endif  // MODEL_POLYLINES_HPP
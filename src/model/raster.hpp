@@ -0,0 +1,538 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MODEL_RASTER_HPP
+#define MODEL_RASTER_HPP
+
+/* External includes */
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <gtkmm/drawingarea.h>
+
+/* Local includes */
+#include "../config/traits.hpp"
+#include "../sys/thread_pool.hpp"
+#include "backend.hpp"
+#include "frame.hpp"
+#include "geometry.hpp"
+
+namespace model
+{
+
+/*================================================================================*/
+/*                                   Definitions                                  */
+/*================================================================================*/
+
+	/* Software backend into an ARGB32 image blitted in one paint. Filled
+	 * polygons are scan converted through a z-buffer, nearest on top, and
+	 * their outlines only show where no nearer polygon hides them; other
+	 * strokes go over everything, as with Cairo. Lines are black, antialiased
+	 * and Traits<Raster>::width pixels wide like Cairo's strokes.
+	 *
+	 * The image is split in tiles rasterized in parallel, each only writing
+	 * its own pixels, with what crosses it in frame order: the result does
+	 * not depend on threads. */
+	class Raster : public Backend
+	{
+	public:
+		Raster()  = default;
+		~Raster() = default;
+
+		void draw(
+			const Cairo::RefPtr<Cairo::Context>& cr,
+			const Frame & frame,
+			const Matrix & viewport_T,
+			int width,
+			int height
+		) override;
+
+		/* Draws frame, through viewport_T, into a cleared width x height image */
+		void rasterize(const Frame & frame, const Matrix & viewport_T, int width, int height);
+
+		//! Premultiplied ARGB32, rows of stride() pixels
+		const std::vector<uint32_t> & pixels() const;
+		int stride() const;
+
+		//! Of the polygons filled by the last rasterize(), counted as fans
+		size_t triangles() const;
+
+	private:
+		using Bins = std::vector<std::vector<unsigned>>; //!< What crosses each tile
+
+		//! Where x cuts a scanline, and +1 or -1 as the edge goes down or up
+		struct Crossing
+		{
+			double x;
+			int winding;
+
+			bool operator<(const Crossing & other) const;
+		};
+
+		/* Lines are stride doubles each, from the point at 0 to the one at stride / 2 */
+		void bin(const std::vector<double> & lines, size_t stride, Bins & bins) const;
+		void bin_polygons();
+
+		void tile(size_t t);
+
+		/* Nonzero winding, as Cairo fills: pixels whose center is inside */
+		void polygon(size_t p, int left, int top, int right, int bottom, std::vector<Crossing> & crossings);
+
+		/* Box filtered Wu: the coverage of each pixel by the span the line
+		 * takes across its minor axis, one pixel per step of the major one.
+		 * Past its ends, round caps as Cairo's LINE_CAP_ROUND: a segment of
+		 * no length, as a Point draws, is a dot. When tested, a and b have a
+		 * depth, and pixels the z-buffer has nearer are left alone. */
+		void line(const double * a, const double * b, bool tested, int left, int top, int right, int bottom);
+
+		void blend(int x, int y, double coverage);
+
+		std::vector<uint32_t> _pixels;
+		std::vector<float> _depths;  //!< z-buffer: the z of each pixel, greater is nearer
+		int _width{0};
+		int _height{0};
+		int _stride{0};
+
+		size_t _columns{0};  //!< Tiles per row
+		size_t _rows{0};
+
+		/* The last frame drawn, in pixels */
+		std::vector<double> _lines;    //!< x0, y0, x1, y1
+		std::vector<double> _outlines; //!< x0, y0, z0, x1, y1, z1
+		std::vector<double> _points;   //!< x, y, z of the polygons
+		std::vector<size_t> _ends;     //!< Of each polygon in _points
+		std::vector<double> _planes;   //!< z = a x + b y + c of each polygon, as a, b, c
+		size_t _triangles{0};
+
+		Bins _line_bins;
+		Bins _outline_bins;
+		Bins _polygon_bins;
+	};
+
+/*================================================================================*/
+/*                                 Implementaions                                 */
+/*================================================================================*/
+
+	bool Raster::Crossing::operator<(const Crossing & other) const
+	{
+		return x < other.x;
+	}
+
+	void Raster::draw(
+		const Cairo::RefPtr<Cairo::Context>& cr,
+		const Frame & frame,
+		const Matrix & viewport_T,
+		int width,
+		int height
+	)
+	{
+		if (width <= 0 || height <= 0)
+			return;
+
+		rasterize(frame, viewport_T, width, height);
+
+		auto image = Cairo::ImageSurface::create(
+			reinterpret_cast<unsigned char *>(_pixels.data()), Cairo::FORMAT_ARGB32, width, height, 4 * _stride
+		);
+
+		cr->save();
+		cr->set_source(image, 0, 0);
+		cr->paint();
+		cr->restore();
+	}
+
+	void Raster::rasterize(const Frame & frame, const Matrix & viewport_T, int width, int height)
+	{
+		const int size = Traits<Raster>::tile;
+
+		_width = width;
+		_height = height;
+		_stride = Cairo::ImageSurface::format_stride_for_width(Cairo::FORMAT_ARGB32, width) / 4;
+		_pixels.resize(size_t(_stride) * height);
+		_depths.resize(size_t(_stride) * height);
+
+		_columns = (width + size - 1) / size;
+		_rows = (height + size - 1) / size;
+
+		_lines.clear();
+		_outlines.clear();
+		_points.clear();
+		_ends.clear();
+
+		frame.lines(viewport_T, _lines);
+		frame.outlines(viewport_T, _outlines);
+		frame.polygons(viewport_T, _points, _ends);
+
+		for (Bins * bins : {&_line_bins, &_outline_bins, &_polygon_bins})
+		{
+			bins->resize(_columns * _rows);
+
+			for (auto & tile : *bins)
+				tile.clear();
+		}
+
+		bin(_lines, 4, _line_bins);
+		bin(_outlines, 6, _outline_bins);
+		bin_polygons();
+
+		sys::ThreadPool::instance().parallel_for(0, _columns * _rows, 1, [&](size_t t) {
+			tile(t);
+		});
+	}
+
+	const std::vector<uint32_t> & Raster::pixels() const
+	{
+		return _pixels;
+	}
+
+	int Raster::stride() const
+	{
+		return _stride;
+	}
+
+	size_t Raster::triangles() const
+	{
+		return _triangles;
+	}
+
+	void Raster::bin(const std::vector<double> & lines, size_t stride, Bins & bins) const
+	{
+		const int size = Traits<Raster>::tile;
+		const double reach = Traits<Raster>::width / 2 + 1;
+
+		/* Each tile row gets the part of the line within its band, widened
+		 * by what a pixel of the line reaches */
+		for (size_t i = 0; stride * i + stride <= lines.size(); ++i)
+		{
+			const double * a = &lines[stride * i];
+			const double * b = a + stride / 2;
+			const double dx = b[0] - a[0], dy = b[1] - a[1];
+
+			const double top = std::max(0.0, std::floor((std::min(a[1], b[1]) - reach) / size));
+			const double bottom = std::min(_rows - 1.0, std::floor((std::max(a[1], b[1]) + reach) / size));
+
+			for (double r = top; r <= bottom; ++r)
+			{
+				double t0 = 0, t1 = 1;
+
+				if (dy != 0)
+				{
+					const double ta = (r * size - reach - a[1]) / dy;
+					const double tb = ((r + 1) * size + reach - a[1]) / dy;
+
+					t0 = std::max(t0, std::min(ta, tb));
+					t1 = std::min(t1, std::max(ta, tb));
+				}
+
+				if (t0 > t1)
+					continue;
+
+				const double xa = a[0] + t0 * dx, xb = a[0] + t1 * dx;
+				const double left = std::max(0.0, std::floor((std::min(xa, xb) - reach) / size));
+				const double right = std::min(_columns - 1.0, std::floor((std::max(xa, xb) + reach) / size));
+
+				for (double c = left; c <= right; ++c)
+					bins[size_t(r) * _columns + size_t(c)].push_back(i);
+			}
+		}
+	}
+
+	void Raster::bin_polygons()
+	{
+		const int size = Traits<Raster>::tile;
+
+		_planes.resize(3 * _ends.size());
+		_triangles = 0;
+
+		for (size_t p = 0, first = 0; p < _ends.size(); first = _ends[p++])
+		{
+			const double * points = &_points[3 * first];
+			const size_t n = _ends[p] - first;
+
+			if (n < 3)
+				continue;
+
+			/* Newell's normal and the centroid: the plane of the polygon on
+			 * screen, where z is linear */
+			double nx = 0, ny = 0, nz = 0, cx = 0, cy = 0, cz = 0;
+			double xmin = points[0], xmax = points[0], ymin = points[1], ymax = points[1];
+
+			for (size_t i = 0; i < n; ++i)
+			{
+				const double * v = &points[3 * i];
+				const double * w = &points[3 * ((i + 1) % n)];
+
+				nx += (v[1] - w[1]) * (v[2] + w[2]);
+				ny += (v[2] - w[2]) * (v[0] + w[0]);
+				nz += (v[0] - w[0]) * (v[1] + w[1]);
+
+				cx += v[0];
+				cy += v[1];
+				cz += v[2];
+
+				xmin = std::min(xmin, v[0]);
+				xmax = std::max(xmax, v[0]);
+				ymin = std::min(ymin, v[1]);
+				ymax = std::max(ymax, v[1]);
+			}
+
+			//! Seen edge on: no pixel center inside
+			if (nz == 0)
+				continue;
+
+			_planes[3 * p] = -nx / nz;
+			_planes[3 * p + 1] = -ny / nz;
+			_planes[3 * p + 2] = (cz - _planes[3 * p] * cx - _planes[3 * p + 1] * cy) / n;
+
+			_triangles += n - 2;
+
+			const double top = std::max(0.0, std::floor(ymin / size));
+			const double bottom = std::min(_rows - 1.0, std::floor(ymax / size));
+			const double left = std::max(0.0, std::floor(xmin / size));
+			const double right = std::min(_columns - 1.0, std::floor(xmax / size));
+
+			for (double r = top; r <= bottom; ++r)
+				for (double c = left; c <= right; ++c)
+					_polygon_bins[size_t(r) * _columns + size_t(c)].push_back(p);
+		}
+	}
+
+	void Raster::tile(size_t t)
+	{
+		const int size = Traits<Raster>::tile;
+
+		const int left = int(t % _columns) * size;
+		const int top = int(t / _columns) * size;
+		const int right = std::min(left + size, _width);
+		const int bottom = std::min(top + size, _height);
+
+		for (int y = top; y < bottom; ++y)
+		{
+			const size_t row = size_t(y) * _stride;
+
+			std::fill(_pixels.data() + row + left, _pixels.data() + row + right, 0);
+			std::fill(_depths.data() + row + left, _depths.data() + row + right, -std::numeric_limits<float>::infinity());
+		}
+
+		std::vector<Crossing> crossings;
+
+		for (unsigned p : _polygon_bins[t])
+			polygon(p, left, top, right, bottom, crossings);
+
+		for (unsigned i : _outline_bins[t])
+			line(&_outlines[6 * i], &_outlines[6 * i + 3], true, left, top, right, bottom);
+
+		for (unsigned i : _line_bins[t])
+			line(&_lines[4 * i], &_lines[4 * i + 2], false, left, top, right, bottom);
+	}
+
+	void Raster::polygon(size_t p, int left, int top, int right, int bottom, std::vector<Crossing> & crossings)
+	{
+		/* Frame's fills: 0.5 gray, opaque */
+		const uint32_t gray = 0xff808080;
+
+		const size_t first = p ? _ends[p - 1] : 0;
+		const size_t n = _ends[p] - first;
+		const double * points = &_points[3 * first];
+		const double a = _planes[3 * p], b = _planes[3 * p + 1], c = _planes[3 * p + 2];
+
+		double ymin = points[1], ymax = points[1];
+
+		for (size_t i = 1; i < n; ++i)
+		{
+			ymin = std::min(ymin, points[3 * i + 1]);
+			ymax = std::max(ymax, points[3 * i + 1]);
+		}
+
+		/* Rows whose center is within [ymin, ymax) */
+		const int from = int(std::max<double>(top, std::ceil(ymin - 0.5)));
+		const int to = int(std::min<double>(bottom, std::ceil(ymax - 0.5)));
+
+		for (int y = from; y < to; ++y)
+		{
+			const double center = y + 0.5;
+
+			crossings.clear();
+
+			/* Half open in y: a scanline through a shared vertex counts once */
+			for (size_t i = 0; i < n; ++i)
+			{
+				const double * u = &points[3 * i];
+				const double * v = &points[3 * ((i + 1) % n)];
+				const int winding = v[1] > u[1] ? 1 : -1;
+
+				if (winding < 0)
+					std::swap(u, v);
+
+				if (center < u[1] || center >= v[1])
+					continue;
+
+				crossings.push_back({u[0] + (center - u[1]) * (v[0] - u[0]) / (v[1] - u[1]), winding});
+			}
+
+			std::sort(crossings.begin(), crossings.end());
+
+			int winding = 0;
+
+			for (size_t k = 0; k + 1 < crossings.size(); ++k)
+			{
+				winding += crossings[k].winding;
+
+				if (!winding)
+					continue;
+
+				const int begin = int(std::max<double>(left, std::ceil(crossings[k].x - 0.5)));
+				const int end = int(std::min<double>(right, std::ceil(crossings[k + 1].x - 0.5)));
+
+				const size_t row = size_t(y) * _stride;
+
+				for (int x = begin; x < end; ++x)
+				{
+					const float z = float(a * (x + 0.5) + b * center + c);
+
+					if (z > _depths[row + x])
+					{
+						_depths[row + x] = z;
+						_pixels[row + x] = gray;
+					}
+				}
+			}
+		}
+	}
+
+	void Raster::line(const double * a, const double * b, bool tested, int left, int top, int right, int bottom)
+	{
+		const bool steep = std::abs(b[1] - a[1]) > std::abs(b[0] - a[0]);
+
+		/* p is the major axis, q the minor one */
+		double p0 = a[0], q0 = a[1], p1 = b[0], q1 = b[1];
+		double z0 = tested ? a[2] : 0, z1 = tested ? b[2] : 0;
+		int p_lo = left, p_hi = right, q_lo = top, q_hi = bottom;
+
+		if (steep)
+		{
+			std::swap(p0, q0);
+			std::swap(p1, q1);
+			std::swap(p_lo, q_lo);
+			std::swap(p_hi, q_hi);
+		}
+
+		if (p0 > p1)
+		{
+			std::swap(p0, p1);
+			std::swap(q0, q1);
+			std::swap(z0, z1);
+		}
+
+		const double radius = Traits<Raster>::width / 2;
+
+		auto plot = [&](int p, int j, double coverage, double z) {
+			const int x = steep ? j : p, y = steep ? p : j;
+
+			if (coverage <= 0)
+				return;
+
+			//! An outline shows on its own polygon, as near as the z-buffer
+			if (tested)
+			{
+				const double depth = _depths[size_t(y) * _stride + x];
+
+				if (z < depth - Traits<Raster>::bias * std::abs(depth))
+					return;
+			}
+
+			blend(x, y, coverage);
+		};
+
+		/* Caps: pixels whose center is past an end along p, covered as much
+		 * as they are within the disc of the line's width around that end */
+		for (int end = 0; end < 2; ++end)
+		{
+			const double pe = end ? p1 : p0, qe = end ? q1 : q0, ze = end ? z1 : z0;
+
+			const int i0 = int(std::max<double>(p_lo, std::floor(pe - radius - 0.5)));
+			const int i1 = int(std::min<double>(p_hi - 1, std::floor(pe + radius + 0.5)));
+			const int j0 = int(std::max<double>(q_lo, std::floor(qe - radius - 0.5)));
+			const int j1 = int(std::min<double>(q_hi - 1, std::floor(qe + radius + 0.5)));
+
+			for (int i = i0; i <= i1; ++i)
+			{
+				const double p = i + 0.5;
+
+				//! The dot of a segment of no length is all start cap
+				if (end ? p <= p1 : (p0 == p1 ? p > p0 : p >= p0))
+					continue;
+
+				for (int j = j0; j <= j1; ++j)
+				{
+					const double distance = std::hypot(p - pe, j + 0.5 - qe);
+
+					plot(i, j, std::min(1.0, radius + 0.5 - distance), ze);
+				}
+			}
+		}
+
+		if (p1 == p0)
+			return;
+
+		const double slope = (q1 - q0) / (p1 - p0);
+		const double half = radius * std::sqrt(1 + slope * slope);
+
+		/* Pixels whose center lies on the line's extent along p */
+		const int first = int(std::max<double>(p_lo, std::ceil(p0 - 0.5)));
+		const int last = int(std::min<double>(p_hi - 1, std::floor(p1 - 0.5)));
+
+		for (int p = first; p <= last; ++p)
+		{
+			const double t = (p + 0.5 - p0) / (p1 - p0);
+			const double q = q0 + t * (q1 - q0);
+			const double z = z0 + t * (z1 - z0);
+			const double from = q - half, to = q + half;
+
+			const int j0 = int(std::max<double>(q_lo, std::floor(from)));
+			const int j1 = int(std::min<double>(q_hi - 1, std::floor(to)));
+
+			for (int j = j0; j <= j1; ++j)
+				plot(p, j, std::min(j + 1.0, to) - std::max(double(j), from), z);
+		}
+	}
+
+	void Raster::blend(int x, int y, double coverage)
+	{
+		/* Black over: the color fades, the alpha grows */
+		uint32_t & pixel = _pixels[size_t(y) * _stride + x];
+		const unsigned alpha = pixel >> 24;
+
+		uint32_t blended = uint32_t(alpha + unsigned(coverage * (255 - alpha) + 0.5)) << 24;
+
+		for (int shift = 0; shift < 24; shift += 8)
+			blended |= uint32_t(((pixel >> shift) & 0xff) * (1 - coverage) + 0.5) << shift;
+
+		pixel = blended;
+	}
+
+} //! namespace model
+
+#endif  // MODEL_RASTER_HPP
@@ -0,0 +1,177 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MODEL_SEGMENTS_HPP
+#define MODEL_SEGMENTS_HPP
+
+/* External includes */
+#include <array>
+#include <vector>
+
+/* Local includes */
+#include "../config/traits.hpp"
+#include "geometry.hpp"
+#include "kernel.hpp"
+
+namespace model
+{
+
+/*================================================================================*/
+/*                                   Definitions                                  */
+/*================================================================================*/
+
+	/* Segments stored as x0[], y0[], x1[], y1[]: clipped in one kernel call */
+	class Segments
+	{
+	public:
+		Segments()  = default;
+		~Segments() = default;
+
+		void add(const Vector & a, const Vector & b);
+
+		//! One segment per pair of consecutive vectors
+		void add_polyline(const std::vector<Vector> & vectors);
+		void add_polyline(const Vector * vectors, size_t count);
+
+		//! Same, except into the vectors starting a new piece (see Shape::_breaks)
+		void add_polyline(const std::vector<Vector> & vectors, const std::vector<size_t> & breaks);
+
+		size_t size() const;
+
+		/* Keeps the visible part of each segment, dropping the others */
+		void clip(const Vector & min, const Vector & max);
+
+		Vector from(size_t i) const;
+		Vector to(size_t i) const;
+
+		//! Position segment i had when added
+		unsigned source(size_t i) const;
+
+		/* Appends from, to of segments [first, last) */
+		void points(size_t first, size_t last, std::vector<Vector> & out) const;
+
+	private:
+		std::array<std::vector<double>, 4> _coordinates;
+		std::vector<unsigned> _sources;
+	};
+
+/*================================================================================*/
+/*                                 Implementaions                                 */
+/*================================================================================*/
+
+	void Segments::add(const Vector & a, const Vector & b)
+	{
+		_coordinates[0].push_back(a[0]);
+		_coordinates[1].push_back(a[1]);
+		_coordinates[2].push_back(b[0]);
+		_coordinates[3].push_back(b[1]);
+		_sources.push_back(_sources.size());
+	}
+
+	void Segments::add_polyline(const std::vector<Vector> & vectors)
+	{
+		add_polyline(vectors.data(), vectors.size());
+	}
+
+	void Segments::add_polyline(const Vector * vectors, size_t count)
+	{
+		if (count < 2)
+			return;
+
+		for (size_t i = 0; i + 1 < count; ++i)
+			add(vectors[i], vectors[i + 1]);
+	}
+
+	void Segments::add_polyline(const std::vector<Vector> & vectors, const std::vector<size_t> & breaks)
+	{
+		if (breaks.empty())
+		{
+			add_polyline(vectors);
+			return;
+		}
+
+		for (size_t i = 0, piece = 0; i + 1 < vectors.size(); ++i)
+		{
+			if (piece < breaks.size() && breaks[piece] == i + 1)
+			{
+				++piece;
+				continue;
+			}
+
+			add(vectors[i], vectors[i + 1]);
+		}
+	}
+
+	size_t Segments::size() const
+	{
+		return _sources.size();
+	}
+
+	void Segments::clip(const Vector & min, const Vector & max)
+	{
+		if (_sources.empty())
+			return;
+
+		const double box[4] = {min[0], min[1], max[0], max[1]};
+		double * const coordinates[4] = {&_coordinates[0][0], &_coordinates[1][0], &_coordinates[2][0], &_coordinates[3][0]};
+		std::vector<unsigned> kept(_sources.size());
+
+		const size_t count = kernel::clip_segments(coordinates, _sources.size(), box, coordinates, &kept[0]);
+
+		//! Kept indices only grow: sources compact in place
+		for (size_t i = 0; i < count; ++i)
+			_sources[i] = _sources[kept[i]];
+
+		_sources.resize(count);
+
+		for (auto & c : _coordinates)
+			c.resize(count);
+	}
+
+	Vector Segments::from(size_t i) const
+	{
+		return Vector(_coordinates[0][i], _coordinates[1][i]);
+	}
+
+	Vector Segments::to(size_t i) const
+	{
+		return Vector(_coordinates[2][i], _coordinates[3][i]);
+	}
+
+	unsigned Segments::source(size_t i) const
+	{
+		return _sources[i];
+	}
+
+	void Segments::points(size_t first, size_t last, std::vector<Vector> & out) const
+	{
+		for (size_t i = first; i < last; ++i)
+		{
+			out.push_back(from(i));
+			out.push_back(to(i));
+		}
+	}
+
+} //! namespace model
+
+#endif  // MODEL_SEGMENTS_HPP
@@ -25,11 +25,16 @@
 #define MODEL_SHAPE_HPP
 
 /* External includes */
+#include <memory>
 #include <string>
-#include <gtkmm/drawingarea.h>
 
 /* Local includes */
+#include "box.hpp"
+#include "clip_space.hpp"
+#include "frame.hpp"
 #include "geometry.hpp"
+#include "kernel.hpp"
+#include "vertex_buffer.hpp"
 
 namespace model
 {
@@ -71,21 +76,61 @@ namespace model
 			_normal = _normal + mass_center();
 		}
 
+		/* Vertices live in a buffer shared with the owner (see ComplexShape) */
+		Shape(std::string name,
+			  const std::shared_ptr<VertexBuffer>& buffer,
+			  const std::vector<VertexBuffer::Index>& indices,
+			  bool close_path = false) :
+			_name(name),
+			_world_vectors(),
+			_buffer(buffer),
+			_indices(indices),
+			_close_path(close_path)
+		{
+			_normal = _normal + mass_center();
+		}
+
 		virtual ~Shape() = default;
 
 		virtual Vector mass_center() const;
 		virtual Vector normal() const;
 
+		/* Clips against the depth planes in clip space, then divides: culls
+		 * the shape when nothing is in front of the eye */
 		virtual void perspective();
+
+		/* Between perspective() and clipping(), whatever clipping is: finds
+		 * the faces to cull, which clipping() and draw() only read */
+		virtual void facing();
+
 		virtual void clipping(const Vector & min, const Vector & max);
 
 		virtual void w_transformation(const Matrix & window_T);
 		virtual void transformation(const Matrix & world_T);
-		virtual void draw(const Cairo::RefPtr<Cairo::Context>& cr, const Matrix & viewport_T);
+		virtual void draw(Frame & frame);
 
 		std::string name();
 		virtual std::string type();
 
+		/* Shared vertices, null when the shape owns its vectors */
+		const std::shared_ptr<VertexBuffer> & buffer() const;
+		const std::vector<VertexBuffer::Index> & indices() const;
+
+		/* World vertices the shape transforms */
+		virtual size_t vertices() const;
+
+		/* World bounds, cached until the next transformation */
+		const Box & bounds() const;
+
+		/* Frustum culling: skips the shape while nothing of it reaches view */
+		virtual bool cull(const ViewVolume & view);
+		bool culled() const;
+
+		/* Incremental pipeline: does the shape need to be built again? */
+		bool outdated(unsigned long window_version) const;
+		void built(unsigned long window_version);
+		void invalidate(); //!< Built again next time, as if its world vectors changed
+
 		friend Debug & operator<<(Debug & db, const Shape & s)
 		{
 			for (const Vector & v : s._world_vectors)
@@ -97,11 +142,23 @@ namespace model
 	protected:
 		// void default_clipping(const Vector & min, const Vector & max);
 
+		virtual Box world_bounds() const;
+
 		std::string _name{"Shape"};
 		std::vector<Vector> _world_vectors{{0, 0}};
 		std::vector<Vector> _window_vectors{{0, 0}};
+		std::vector<size_t> _breaks;       //!< Window vectors starting a new piece of the path
+		std::shared_ptr<VertexBuffer> _buffer;
+		std::vector<VertexBuffer::Index> _indices;
 		Vector _normal{0, 0, 1};
 		const bool _close_path{false};
+
+		bool _dirty{true};                 //!< World vectors changed since last build
+		unsigned long _window_version{0};  //!< Window version of the last build
+
+		mutable Box _bounds;
+		mutable bool _bounded{false};      //!< _bounds matches the world vectors
+		bool _culled{false};               //!< Outside the view (or behind the eye) at the last build
 	};
 
 /*================================================================================*/
@@ -110,7 +167,7 @@ namespace model
 
 	Vector Shape::mass_center() const
 	{
-		double total = _world_vectors.size();
+		double total = _buffer ? _indices.size() : _world_vectors.size();
 		double x = 0, y = 0, z = 0, w = 0;
 
 		for (const auto &v : _world_vectors)
@@ -121,6 +178,16 @@ namespace model
 			w += v[3];
 		}
 
+		for (const auto &i : _indices)
+		{
+			const Vector v = _buffer->world(i);
+
+			x += v[0];
+			y += v[1];
+			z += v[2];
+			w += v[3];
+		}
+
 		return Vector(
 			x/total,
 			y/total,
@@ -136,42 +203,47 @@ namespace model
 
 	void Shape::w_transformation(const Matrix & window_T)
 	{
-		std::vector<Vector> vectors;
-
-		for (auto & v : _world_vectors)
-			vectors.emplace_back(v * window_T);
-
-		_window_vectors = std::move(vectors);
+		//! Shared vertices were already transformed by the buffer owner
+		if (_buffer)
+			_buffer->gather(_indices, _window_vectors);
+		else
+			kernel::transform_points(window_T, _world_vectors, _window_vectors);
 	}
 
 	void Shape::transformation(const Matrix & world_T)
 	{	
-		for (auto & v : _world_vectors)
-			v = v * world_T;
+		if (!_buffer)
+			kernel::transform_points(world_T, _world_vectors);
 
 		_normal = _normal * world_T;
+		_dirty = true;
+		_bounded = false;
 	}
 
-	void Shape::draw(const Cairo::RefPtr<Cairo::Context>& cr, const Matrix & viewport_T)
+	void Shape::draw(Frame & frame)
 	{
 		if (_window_vectors.empty())
 			return;
 
-		Vector v0 = _window_vectors[0] * viewport_T;
-
 		/* First point */
-		cr->move_to(v0[0], v0[1]);
+		frame.move_to(_window_vectors[0]);
 
 		// Draw all other points
-		for (Vector& v : _window_vectors)
+		for (size_t i = 0, piece = 0; i < _window_vectors.size(); ++i)
 		{
-			Vector vi = v * viewport_T;
-			cr->line_to(vi[0], vi[1]);
+			//! Pieces left by clip_space::clip() do not join
+			if (piece < _breaks.size() && _breaks[piece] == i)
+			{
+				frame.move_to(_window_vectors[i]);
+				++piece;
+			}
+			else
+				frame.line_to(_window_vectors[i]);
 		}
 		
 		//! Complete path
 		if (_close_path)
-			cr->close_path();
+			frame.close_path();
 	}
 
 	std::string Shape::name()
@@ -179,38 +251,113 @@ namespace model
 		return _name;
 	}
 
+	const std::shared_ptr<VertexBuffer> & Shape::buffer() const
+	{
+		return _buffer;
+	}
+
+	const std::vector<VertexBuffer::Index> & Shape::indices() const
+	{
+		return _indices;
+	}
+
+	size_t Shape::vertices() const
+	{
+		return _buffer ? _indices.size() : _world_vectors.size();
+	}
+
+	const Box & Shape::bounds() const
+	{
+		if (!_bounded)
+		{
+			_bounds = world_bounds();
+			_bounded = true;
+		}
+
+		return _bounds;
+	}
+
+	Box Shape::world_bounds() const
+	{
+		Box box;
+
+		for (const auto & v : _world_vectors)
+			box.extend(v);
+
+		for (const auto & i : _indices)
+			box.extend(_buffer->world(i));
+
+		return box;
+	}
+
+	bool Shape::cull(const ViewVolume & view)
+	{
+		_culled = view.outside(bounds());
+		return _culled;
+	}
+
+	bool Shape::culled() const
+	{
+		return _culled;
+	}
+
 	std::string Shape::type()
 	{
 		return "Shape_t";
 	}
+
+	bool Shape::outdated(unsigned long window_version) const
+	{
+		return _dirty || _window_version != window_version;
+	}
+
+	void Shape::built(unsigned long window_version)
+	{
+		_dirty = false;
+		_window_version = window_version;
+	}
+
+	void Shape::invalidate()
+	{
+		_dirty = true;
+	}
 	
 	void Shape::perspective()
 	{
-		const double d = Traits<model::Window>::perspective_factor;
+		_breaks.clear();
+		_culled = false;
 
-		Matrix M(
-			{1, 0, 0, 0},
-			{0, 1, 0, 0},
-			{0, 0, 1, 0},
-			{0, 0, d, 1}
-		);
+		if (_buffer)
+		{
+			//! Shared vertices were already projected by the buffer owner
+			if (!_buffer->outcodes(_indices))
+			{
+				_buffer->gather(_indices, _window_vectors);
+				return;
+			}
+
+			_buffer->gather_clip(_indices, _window_vectors);
+		}
+		else
+			kernel::transform_points(clip_space::projection(), _window_vectors);
 
-		for (auto &v: _window_vectors)
+		//! Behind the eye or past the far plane: nothing to clip nor draw
+		if (!clip_space::clip(_window_vectors, _close_path, _breaks))
 		{
-			v = v * M;
-				
-			if (v[2] >= 0)
-				continue;
-
-			v[0] = v[0] * d / v[2];
-			v[1] = v[1] * d / v[2];
-			v[2] = d;
+			_culled = true;
+			return;
 		}
+
+		clip_space::divide(_window_vectors);
+	}
+
+	void Shape::facing()
+	{
 	}
 
 	void Shape::clipping(const Vector & min, const Vector & max)
 	{
-		db<Shape>(INF) << "[" << this << "] Clipping: I'm only a Shape dude!" << std::endl;
+		DB(Shape, INF) << "[" << this << "] Clipping: I'm only a Shape dude!" << std::endl;
 	}
 
 } //! namespace model
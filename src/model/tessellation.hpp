@@ -0,0 +1,263 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MODEL_TESSELLATION_HPP
+#define MODEL_TESSELLATION_HPP
+
+/* External includes */
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+/* Local includes */
+#include "../config/traits.hpp"
+#include "geometry.hpp"
+#include "kernel.hpp"
+
+namespace model
+{
+
+/*================================================================================*/
+/*                                   Definitions                                  */
+/*================================================================================*/
+
+	/* Cubic segments of curves, in window coordinates, turned into polylines.
+	 * Adaptive bounds the bend of the control hull (Wang's formula) to pick
+	 * the fewest segments keeping the curve within Traits<Tessellation>::
+	 * tolerance pixels of them: the vertices emitted follow the size the
+	 * curve takes on screen. */
+	class Tessellation
+	{
+	public:
+		enum class Method
+		{
+			Uniform,  //!< Traits<Tessellation>::samples segments each
+			Adaptive
+		};
+
+		static Method method;
+
+		/* Pixels the window spans on screen: sets what a pixel is worth */
+		static void viewport(double width, double height);
+
+		/* Segments the cubic bezier with controls p[0..3], in window
+		 * coordinates, takes under the current method */
+		static unsigned segments(const Vector * p);
+
+		/* Appends that cubic, in n segments, to out, p[0] only when out is
+		 * empty: consecutive cubics share it */
+		static void bezier(const Vector * p, unsigned n, std::vector<Vector> & out);
+
+		//! Bezier controls b[0..3] of one segment of a uniform cubic b-spline
+		static void b_spline(const Vector * p, Vector * b);
+
+	private:
+		//! Appends the n segments of the cubic p[0..3] but its start
+		static void evaluate(const Vector * p, unsigned n, std::vector<Vector> & out);
+
+		//! Window units per pixel: [-1, 1] over 800 pixels until told otherwise
+		static std::atomic<double> _pixel;
+	};
+
+	/* A curve of cubic beziers tessellated in world space: the window only
+	 * transforms the cached points, unless the controls changed (clear())
+	 * or it needs other segment counts than those cached */
+	class TessellationCache
+	{
+	public:
+		TessellationCache()  = default;
+		~TessellationCache() = default;
+
+		//! Bezier controls, 4 per cubic, in world space
+		void assign(std::vector<Vector> && controls);
+		void clear();
+		bool empty() const;
+
+		/* The curve under window_T */
+		void w_transformation(const Matrix & window_T, std::vector<Vector> & out);
+
+	private:
+		std::vector<Vector> _controls;
+		std::vector<unsigned> _segments;  //!< Of each cubic in _points
+		std::vector<Vector> _points;      //!< Empty until tessellated
+	};
+
+/*================================================================================*/
+/*                                 Implementaions                                 */
+/*================================================================================*/
+
+	Tessellation::Method Tessellation::method{Tessellation::Method::Adaptive};
+
+	std::atomic<double> Tessellation::_pixel{2.0 / 800};
+
+	void Tessellation::viewport(double width, double height)
+	{
+		/* The normalized window spans [-1, 1]: the smaller pixel of both axes */
+		_pixel = std::min(2 / width, 2 / height);
+	}
+
+	unsigned Tessellation::segments(const Vector * p)
+	{
+		if (method == Method::Uniform)
+			return Traits<Tessellation>::samples;
+
+		double tolerance = Traits<Tessellation>::tolerance * _pixel;
+
+		/* The divide magnifies by -d / w: the nearest control sets the scale */
+		if (Traits<Window>::has_perspective)
+		{
+			const double d = Traits<Window>::perspective_factor;
+			double nearest = Traits<Window>::far_plane;
+
+			for (int i = 0; i < 4; ++i)
+				nearest = std::min(nearest, -(p[i][2] + d));
+
+			tolerance *= std::max(nearest, Traits<Window>::near_plane) / -d;
+		}
+
+		/* Second differences of the hull bound the curvature: n segments
+		 * stray at most 3 / 4 * max |d| / n^2 from the curve */
+		double bend = 0;
+
+		for (int k = 0; k < 2; ++k)
+		{
+			const double dx = p[k][0] - 2 * p[k + 1][0] + p[k + 2][0];
+			const double dy = p[k][1] - 2 * p[k + 1][1] + p[k + 2][1];
+
+			bend = std::max(bend, dx * dx + dy * dy);
+		}
+
+		const double n = std::ceil(std::sqrt(0.75 * std::sqrt(bend) / tolerance));
+
+		return n < 1 ? 1 : (n > Traits<Tessellation>::segments ? Traits<Tessellation>::segments : unsigned(n));
+	}
+
+	void Tessellation::bezier(const Vector * p, unsigned n, std::vector<Vector> & out)
+	{
+		if (out.empty())
+			out.push_back(p[0]);
+
+		evaluate(p, n, out);
+	}
+
+	void Tessellation::b_spline(const Vector * p, Vector * b)
+	{
+		for (int i = 0; i < 3; ++i)
+		{
+			b[0][i] = (p[0][i] + 4 * p[1][i] + p[2][i]) / 6;
+			b[1][i] = (2 * p[1][i] + p[2][i]) / 3;
+			b[2][i] = (p[1][i] + 2 * p[2][i]) / 3;
+			b[3][i] = (p[1][i] + 4 * p[2][i] + p[3][i]) / 6;
+		}
+	}
+
+	void Tessellation::evaluate(const Vector * p, unsigned n, std::vector<Vector> & out)
+	{
+		const double h = 1.0 / n;
+		double f[3], d1[3], d2[3], d3[3];
+
+		/* f(t) = a t^3 + b t^2 + c t + p[0], and its differences for step h */
+		for (int i = 0; i < 3; ++i)
+		{
+			const double a = -p[0][i] + 3 * p[1][i] - 3 * p[2][i] + p[3][i];
+			const double b = 3 * p[0][i] - 6 * p[1][i] + 3 * p[2][i];
+			const double c = -3 * p[0][i] + 3 * p[1][i];
+
+			f[i] = p[0][i];
+			d1[i] = ((a * h + b) * h + c) * h;
+			d2[i] = (6 * a * h + 2 * b) * h * h;
+			d3[i] = 6 * a * h * h * h;
+		}
+
+		for (unsigned k = 1; k < n; ++k)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				f[i] += d1[i];
+				d1[i] += d2[i];
+				d2[i] += d3[i];
+			}
+
+			out.emplace_back(f[0], f[1], f[2]);
+		}
+
+		//! Exact end: the next segment starts there
+		out.push_back(p[3]);
+	}
+
+	void TessellationCache::assign(std::vector<Vector> && controls)
+	{
+		_controls = std::move(controls);
+		_points.clear();
+	}
+
+	void TessellationCache::clear()
+	{
+		_controls.clear();
+		_points.clear();
+	}
+
+	bool TessellationCache::empty() const
+	{
+		return _controls.empty();
+	}
+
+	void TessellationCache::w_transformation(const Matrix & window_T, std::vector<Vector> & out)
+	{
+		std::vector<Vector> controls;
+		kernel::transform_points(window_T, _controls, controls);
+
+		const size_t cubics = controls.size() / 4;
+		bool stale = _points.empty();
+
+		_segments.resize(cubics);
+
+		/* Finer than needed is kept up to twice: zooming does not rebuild
+		 * every frame. Affine maps commute with the polynomials, so the
+		 * window points are the cached ones transformed. */
+		for (size_t k = 0; k < cubics; ++k)
+		{
+			const unsigned needed = Tessellation::segments(&controls[4 * k]);
+
+			if (stale || _segments[k] < needed || _segments[k] > 2 * needed)
+			{
+				stale = true;
+				_segments[k] = needed;
+			}
+		}
+
+		if (stale)
+		{
+			_points.clear();
+
+			for (size_t k = 0; k < cubics; ++k)
+				Tessellation::bezier(&_controls[4 * k], _segments[k], _points);
+		}
+
+		kernel::transform_points(window_T, _points, out);
+	}
+
+} //! namespace model
+
+#endif  // MODEL_TESSELLATION_HPP
@@ -0,0 +1,234 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MODEL_VERTEX_BUFFER_HPP
+#define MODEL_VERTEX_BUFFER_HPP
+
+/* External includes */
+#include <array>
+#include <utility>
+#include <vector>
+
+/* Local includes */
+#include "../config/traits.hpp"
+#include "clip_space.hpp"
+#include "geometry.hpp"
+#include "kernel.hpp"
+
+namespace model
+{
+
+/*================================================================================*/
+/*                                   Definitions                                  */
+/*================================================================================*/
+
+	/* Vertices shared by the shapes of a loaded model, stored as x[], y[], z[], w[] */
+	class VertexBuffer
+	{
+	public:
+		using Index = unsigned;
+		using Range = std::pair<size_t, size_t>; //!< [first, last) vertices
+
+		VertexBuffer()  = default;
+		~VertexBuffer() = default;
+
+		Index add(const Vector & v);
+		void reserve(size_t n);
+		size_t size() const;
+
+		/* Whole world coordinate arrays, one per dimension */
+		const double * coordinates(int coordinate) const;
+		void assign(const double * const world[Vector::dimension], size_t n);
+
+		Vector world(Index i) const;
+		Vector window(Index i) const;
+
+		void transformation(const Matrix & world_T);
+		void w_transformation(const Matrix & window_T);
+		void perspective();
+
+		/* Only the given ranges, for the visible part of a culled model */
+		void w_transformation(const Matrix & window_T, const std::vector<Range> & ranges);
+		void perspective(const std::vector<Range> & ranges);
+
+		/* Copies the window coordinates of the given vertices into out */
+		void gather(const std::vector<Index> & indices, std::vector<Vector> & out) const;
+
+		/* After perspective(): clip space coordinates of the given vertices,
+		 * and the clip_space::Plane bits any of them is outside of */
+		void gather_clip(const std::vector<Index> & indices, std::vector<Vector> & out) const;
+		unsigned outcodes(const std::vector<Index> & indices) const;
+
+	private:
+		using Coordinates = std::array<std::vector<double>, Vector::dimension>;
+
+		static void transform(const Matrix & M, const Coordinates & in, Coordinates & out, const Range & range);
+
+		Coordinates _world;
+		Coordinates _window;
+		Coordinates _clip;
+
+		//! Divided into _window only where zero
+		std::vector<unsigned char> _outcodes;
+		unsigned _crossing{0};  //!< Any of _outcodes: when zero, none needs a look
+	};
+
+/*================================================================================*/
+/*                                 Implementaions                                 */
+/*================================================================================*/
+
+	VertexBuffer::Index VertexBuffer::add(const Vector & v)
+	{
+		for (int i = 0; i < Vector::dimension; ++i)
+			_world[i].push_back(v[i]);
+
+		return _world[0].size() - 1;
+	}
+
+	void VertexBuffer::reserve(size_t n)
+	{
+		for (auto & c : _world)
+			c.reserve(n);
+	}
+
+	size_t VertexBuffer::size() const
+	{
+		return _world[0].size();
+	}
+
+	const double * VertexBuffer::coordinates(int coordinate) const
+	{
+		return _world[coordinate].data();
+	}
+
+	void VertexBuffer::assign(const double * const world[Vector::dimension], size_t n)
+	{
+		for (int i = 0; i < Vector::dimension; ++i)
+			_world[i].assign(world[i], world[i] + n);
+	}
+
+	Vector VertexBuffer::world(Index i) const
+	{
+		return Vector(_world[0][i], _world[1][i], _world[2][i], _world[3][i]);
+	}
+
+	Vector VertexBuffer::window(Index i) const
+	{
+		return Vector(_window[0][i], _window[1][i], _window[2][i], _window[3][i]);
+	}
+
+	void VertexBuffer::transform(const Matrix & M, const Coordinates & in, Coordinates & out, const Range & range)
+	{
+		for (auto & c : out)
+			c.resize(in[0].size());
+
+		if (range.first >= range.second)
+			return;
+
+		const size_t i = range.first;
+		const double * const src[4] = {&in[0][i], &in[1][i], &in[2][i], &in[3][i]};
+		double * const dst[4] = {&out[0][i], &out[1][i], &out[2][i], &out[3][i]};
+
+		kernel::transform_soa(M, src, dst, range.second - range.first);
+	}
+
+	void VertexBuffer::transformation(const Matrix & world_T)
+	{
+		transform(world_T, _world, _world, {0, size()});
+	}
+
+	void VertexBuffer::w_transformation(const Matrix & window_T)
+	{
+		w_transformation(window_T, {{0, size()}});
+	}
+
+	void VertexBuffer::w_transformation(const Matrix & window_T, const std::vector<Range> & ranges)
+	{
+		for (auto & range : ranges)
+			transform(window_T, _world, _window, range);
+	}
+
+	void VertexBuffer::perspective()
+	{
+		perspective({{0, size()}});
+	}
+
+	void VertexBuffer::perspective(const std::vector<Range> & ranges)
+	{
+		_outcodes.resize(size());
+		_crossing = 0;
+
+		for (auto & range : ranges)
+		{
+			transform(clip_space::projection(), _window, _clip, range);
+
+			for (size_t i = range.first; i < range.second; ++i)
+			{
+				_outcodes[i] = clip_space::outcode(_clip[3][i]);
+				_crossing |= _outcodes[i];
+
+				if (_outcodes[i])
+					continue;
+
+				_window[0][i] = _clip[0][i] / _clip[3][i];
+				_window[1][i] = _clip[1][i] / _clip[3][i];
+				_window[2][i] = 1 / _clip[3][i];
+			}
+		}
+	}
+
+	void VertexBuffer::gather(const std::vector<Index> & indices, std::vector<Vector> & out) const
+	{
+		out.resize(indices.size());
+
+		for (size_t k = 0; k < indices.size(); ++k)
+			out[k] = window(indices[k]);
+	}
+
+	void VertexBuffer::gather_clip(const std::vector<Index> & indices, std::vector<Vector> & out) const
+	{
+		out.resize(indices.size());
+
+		for (size_t k = 0; k < indices.size(); ++k)
+		{
+			const Index i = indices[k];
+			out[k] = Vector(_clip[0][i], _clip[1][i], _clip[2][i], _clip[3][i]);
+		}
+	}
+
+	unsigned VertexBuffer::outcodes(const std::vector<Index> & indices) const
+	{
+		unsigned any = 0;
+
+		if (!_crossing)
+			return any;
+
+		for (auto i : indices)
+			any |= _outcodes[i];
+
+		return any;
+	}
+
+} //! namespace model
+
+#endif  // MODEL_VERTEX_BUFFER_HPP
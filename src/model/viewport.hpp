@@ -25,16 +25,26 @@
 #define MODEL_VIEWPORT_HPP
 
 /* External includes */
+#include <cstdio>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
 #include <gtkmm/drawingarea.h>
+#include <glibmm/dispatcher.h>
 
 /* Local includes */
+#include "backend.hpp"
+#include "frame.hpp"
 #include "geometry.hpp"
 #include "shape.hpp"
 #include "point.hpp"
+#include "raster.hpp"
 #include "line.hpp"
 #include "rectangle.hpp"
 #include "window.hpp"
+#include "../sys/statistics.hpp"
+#include "../sys/trace.hpp"
 
 namespace model
 {
@@ -48,14 +58,14 @@ namespace model
 	public:
 		Viewport(
 			model::Window & window,
-			std::vector<std::shared_ptr<model::Shape>> & shapes,
 			Gtk::DrawingArea& draw_area
 		) :
 			_window(window),
-			_shapes(shapes),
-			_draw_area(draw_area)
+			_draw_area(draw_area),
+			_front(std::make_shared<Frame>())
 		{
 			_draw_area.signal_draw().connect(sigc::mem_fun(*this, &Viewport::on_draw));
+			_presented.connect(sigc::mem_fun(*this, &Viewport::update));
 		}
 
 		~Viewport() = default;
@@ -63,10 +73,30 @@ namespace model
 		void update();
 		const bool on_draw(const Cairo::RefPtr<Cairo::Context>& cr);
 
+		/* Thread safe: swaps frame in and returns the one it replaces */
+		std::shared_ptr<Frame> present(std::shared_ptr<Frame> frame);
+
+		/* Normalized window -> width x height device coordinates */
+		static Matrix transformation(double width, double height);
+
+		/* Clears the surface behind cr and draws frame on it, and the statistics over it */
+		static void paint(const Cairo::RefPtr<Cairo::Context>& cr, const Frame & frame, double width, double height, bool overlay = false);
+
+		/* Shows the pipeline statistics (when Traits<sys::Statistics>::enabled) */
+		void overlay(bool enabled);
+
 	private:
+		//! The one of Backend::kind
+		static Backend & backend();
+
+		static void draw_statistics(const Cairo::RefPtr<Cairo::Context>& cr);
+
 		model::Window & _window;
-		std::vector<std::shared_ptr<model::Shape>>& _shapes;
 		Gtk::DrawingArea &_draw_area;
+
+		std::shared_ptr<Frame> _front;  //!< Accessed only through std::atomic_*
+		Glib::Dispatcher _presented;    //!< Wakes the GTK thread to redraw
+		bool _overlay{Traits<sys::Statistics>::overlay};
 	};
 
 /*================================================================================*/
@@ -78,35 +108,123 @@ namespace model
 		_draw_area.queue_draw();
 	}
 
+	std::shared_ptr<Frame> Viewport::present(std::shared_ptr<Frame> frame)
+	{
+		auto previous = std::atomic_exchange(&_front, frame);
+
+		_presented.emit();
+
+		return previous;
+	}
+
 	const bool Viewport::on_draw(const Cairo::RefPtr<Cairo::Context>& cr)
 	{
 		db<Viewport>(TRC) << "model::Viewport::on_draw()" << std::endl;
 
-		/* Test Paints background (Values range [0.0-1.0]). */
-		cr->set_source_rgb(1, 1, 1);
-		cr->paint();
+		auto alloc = _draw_area.get_allocation();
 
-		/* Line configuration */
-		cr->set_line_cap(Cairo::LINE_CAP_ROUND);
-		cr->set_source_rgb(0, 0, 0);
+		/* Draw the last frame built by the pipeline. */
+		paint(cr, *std::atomic_load(&_front), alloc.get_width(), alloc.get_height(), _overlay);
 
-		/* Build transformation matrix. */
-		auto alloc = _draw_area.get_allocation();
+		return true;
+	}
+
+	Matrix Viewport::transformation(double width, double height)
+	{
 		model::Vector vp_min(0, 0);
-		model::Vector vp_max(alloc.get_width(), alloc.get_height());
+		model::Vector vp_max(width, height);
 		model::Vector win_min = model::Window::fixed_min;
 		model::Vector win_max = model::Window::fixed_max;
 
-		auto T = model::transformation::viewport_transformation(vp_min, vp_max, win_min, win_max);
+		return model::transformation::viewport_transformation(vp_min, vp_max, win_min, win_max);
+	}
+
+	void Viewport::overlay(bool enabled)
+	{
+		_overlay = enabled;
+		_draw_area.queue_draw();
+	}
+
+	Backend & Viewport::backend()
+	{
+		static CairoBackend cairo;
+		static Raster raster;
 
-		/* Draw all shapes. */
-		for (auto & shape : _shapes)
+		if (Backend::kind == Backend::Kind::Raster)
+			return raster;
+
+		return cairo;
+	}
+
+	void Viewport::paint(const Cairo::RefPtr<Cairo::Context>& cr, const Frame & frame, double width, double height, bool overlay)
+	{
 		{
-			shape->draw(cr, T);
-			cr->stroke();
+			sys::Timer timer(sys::Statistics::PAINT);
+			auto span = trace<Viewport>("Viewport::paint");
+
+			/* Test Paints background (Values range [0.0-1.0]). */
+			cr->set_source_rgb(1, 1, 1);
+			cr->paint();
+
+			/* Line configuration */
+			cr->set_line_cap(Cairo::LINE_CAP_ROUND);
+			cr->set_source_rgb(0, 0, 0);
+
+			backend().draw(cr, frame, transformation(width, height), int(width), int(height));
 		}
 
-		return true;
+		if (Traits<sys::Statistics>::enabled && overlay)
+			draw_statistics(cr);
+	}
+
+	//! Last frame numbers and the frame time histogram, on the top left corner
+	void Viewport::draw_statistics(const Cairo::RefPtr<Cairo::Context>& cr)
+	{
+		using Statistics = sys::Statistics;
+
+		const auto & statistics = Statistics::instance();
+		const Statistics::Frame frame = statistics.last();
+		const std::vector<unsigned> histogram = statistics.histogram();
+
+		char text[4][128];
+
+		std::snprintf(text[0], sizeof(text[0]), "frame %.2f ms  p50 %.2f  p95 %.2f",
+			frame.ms[Statistics::FRAME], statistics.percentile(0.5), statistics.percentile(0.95));
+		std::snprintf(text[1], sizeof(text[1]), "w %.2f  persp %.2f  clip %.2f  rec %.2f  paint %.2f ms",
+			frame.ms[Statistics::W_TRANSFORMATION], frame.ms[Statistics::PERSPECTIVE],
+			frame.ms[Statistics::CLIPPING], frame.ms[Statistics::RECORD], frame.ms[Statistics::PAINT]);
+		std::snprintf(text[2], sizeof(text[2]), "shapes %lu built  %lu culled  faces %lu culled",
+			frame.count[Statistics::SHAPES_BUILT], frame.count[Statistics::SHAPES_CULLED], frame.count[Statistics::FACES_CULLED]);
+		std::snprintf(text[3], sizeof(text[3]), "vertices %lu in  %lu out  %lu segments",
+			frame.count[Statistics::VERTICES_IN], frame.count[Statistics::VERTICES_OUT], frame.count[Statistics::SEGMENTS]);
+
+		const double x = 10, y = 10, line = 14, bars = 30;
+
+		cr->save();
+
+		cr->set_source_rgba(1, 1, 1, 0.8);
+		cr->rectangle(x, y, 340, 4 * line + bars + 20);
+		cr->fill();
+
+		cr->set_source_rgb(0.1, 0.1, 0.6);
+		cr->select_font_face("monospace", Cairo::FONT_SLANT_NORMAL, Cairo::FONT_WEIGHT_NORMAL);
+		cr->set_font_size(11);
+
+		for (int i = 0; i < 4; ++i)
+		{
+			cr->move_to(x + 6, y + line * (i + 1));
+			cr->show_text(text[i]);
+		}
+
+		/* One bar per bucket: < 1, 2, 4, 8, 16, 33, 66 ms and the rest */
+		const unsigned most = std::max(1u, *std::max_element(histogram.begin(), histogram.end()));
+		const double base = y + 4 * line + bars + 12;
+
+		for (unsigned b = 0; b < histogram.size(); ++b)
+			cr->rectangle(x + 6 + 40 * b, base, 32, -bars * histogram[b] / most);
+
+		cr->fill();
+		cr->restore();
 	}
 
 } //! namespace model
@@ -70,6 +70,7 @@ namespace model
 		Matrix normalization();
 
 		const Matrix& transformation() const;
+		unsigned long version() const;
 		const Vector& min() const;
 		const Vector& max() const;
 		
@@ -77,6 +78,7 @@ namespace model
 
 	private:
 		Matrix _history;
+		unsigned long _version{0}; //!< Bumped whenever _history changes
 		Vector _min, _max;
 		Rectangle _visible_world;
 	};
@@ -100,7 +102,13 @@ namespace model
 
 	void Window::transformation(const Matrix& T)
 	{
-		_history = _history * T;
+		const Matrix history = _history * T;
+
+		if (history == _history)
+			return;
+
+		_history = history;
+		++_version;
 	}
 
 	const Matrix& Window::transformation() const
@@ -108,6 +116,11 @@ namespace model
 		return _history;
 	}
 
+	unsigned long Window::version() const
+	{
+		return _version;
+	}
+
 	const Vector& Window::min() const
 	{
 		return _min;
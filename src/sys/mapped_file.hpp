@@ -0,0 +1,138 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef SYS_MAPPED_FILE_HPP
+#define SYS_MAPPED_FILE_HPP
+
+/* External includes */
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sys
+{
+
+/*================================================================================*/
+/*                                   Definitions                                  */
+/*================================================================================*/
+
+	/* Read-only view of a whole file: mmap'ed, or read into memory when map is false */
+	class MappedFile
+	{
+	public:
+		explicit MappedFile(const std::string & path, bool map = true);
+		~MappedFile();
+
+		MappedFile(const MappedFile &) = delete;
+		MappedFile &operator=(const MappedFile &) = delete;
+
+		bool is_open() const;
+		const char * data() const;
+		size_t size() const;
+
+	private:
+		bool _open{false};
+		void * _mapping{nullptr};
+		size_t _size{0};
+		std::string _buffer; //!< Used when the file is not mapped
+	};
+
+/*================================================================================*/
+/*                                 Implementaions                                 */
+/*================================================================================*/
+
+	MappedFile::MappedFile(const std::string & path, bool map)
+	{
+		if (map)
+		{
+			int fd = ::open(path.c_str(), O_RDONLY);
+
+			if (fd < 0)
+				return;
+
+			struct stat st;
+
+			if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+			{
+				_open = true;
+				_size = st.st_size;
+
+				if (_size)
+				{
+					_mapping = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+					if (_mapping == MAP_FAILED)
+					{
+						_mapping = nullptr;
+						_open = false;
+					}
+					else
+						::madvise(_mapping, _size, MADV_SEQUENTIAL);
+				}
+			}
+
+			::close(fd);
+
+			if (_open || _mapping)
+				return;
+		}
+
+		/* Not mappable (or not asked to): read it */
+		std::ifstream file(path, std::ios::binary);
+
+		if (!file.is_open())
+			return;
+
+		_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		_size = _buffer.size();
+		_open = true;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (_mapping)
+			::munmap(_mapping, _size);
+	}
+
+	bool MappedFile::is_open() const
+	{
+		return _open;
+	}
+
+	const char * MappedFile::data() const
+	{
+		return _mapping ? static_cast<const char *>(_mapping) : _buffer.data();
+	}
+
+	size_t MappedFile::size() const
+	{
+		return _size;
+	}
+
+} //! namespace sys
+
+#endif  // SYS_MAPPED_FILE_HPP
@@ -0,0 +1,283 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef SYS_STATISTICS_HPP
+#define SYS_STATISTICS_HPP
+
+/* External includes */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/* Local includes */
+#include "../config/traits.hpp"
+
+namespace sys
+{
+
+/*================================================================================*/
+/*                                   Definitions                                  */
+/*================================================================================*/
+
+	/* Per frame stage times and counters of the pipeline, and a rolling window
+	 * of frame times. Stages may be timed from any thread: times add up. */
+	class Statistics
+	{
+	public:
+		enum Stage
+		{
+			W_TRANSFORMATION,
+			PERSPECTIVE,
+			CLIPPING,
+			RECORD,   //!< Shapes drawn into the Frame
+			PAINT,    //!< Frame replayed on Cairo, counted in the frame after it
+			FRAME,    //!< Jobs and render of the pipeline
+			STAGES
+		};
+
+		enum Counter
+		{
+			SHAPES_BUILT,
+			SHAPES_CULLED,  //!< Shapes that drew nothing
+			FACES_CULLED,   //!< Polygons facing away, not clipped nor drawn
+			VERTICES_IN,    //!< World vertices of the built shapes
+			VERTICES_OUT,   //!< Points of the frame
+			SEGMENTS,       //!< Lines of the frame
+			COUNTERS
+		};
+
+		struct Frame
+		{
+			double ms[STAGES];
+			unsigned long count[COUNTERS];
+		};
+
+		/* Frame times below each bound, in ms; the last bucket takes the rest */
+		static const unsigned buckets = 8;
+		static const double bounds[buckets - 1];
+
+		static Statistics & instance();
+
+		void add(Stage stage, std::chrono::steady_clock::duration time);
+		void add(Counter counter, unsigned long amount);
+
+		/* Ends the frame being counted */
+		void close_frame();
+
+		Frame last() const;
+		std::vector<unsigned> histogram() const;
+		double percentile(double p) const;
+
+		std::string report() const;
+		bool dump(const std::string & path) const;
+
+		static const char * name(Stage stage);
+		static const char * name(Counter counter);
+
+	private:
+		Statistics() = default;
+
+		std::atomic<uint64_t> _ns[STAGES] = {};
+		std::atomic<uint64_t> _count[COUNTERS] = {};
+
+		mutable std::mutex _lock;
+		Frame _last{};
+		std::vector<double> _frames;  //!< Ring of the last Traits<Statistics>::frames frame times
+		size_t _next{0};
+	};
+
+	/* Adds the time of its scope to a stage. Empty when statistics are disabled. */
+	template<bool enabled>
+	class Select_Timer
+	{
+	public:
+		explicit Select_Timer(Statistics::Stage stage) :
+			_stage(stage),
+			_begin(std::chrono::steady_clock::now())
+		{
+		}
+
+		~Select_Timer()
+		{
+			Statistics::instance().add(_stage, std::chrono::steady_clock::now() - _begin);
+		}
+
+	private:
+		Statistics::Stage _stage;
+		std::chrono::steady_clock::time_point _begin;
+	};
+
+	template<>
+	class Select_Timer<false>
+	{
+	public:
+		explicit Select_Timer(Statistics::Stage) {}
+	};
+
+	using Timer = Select_Timer<Traits<Statistics>::enabled>;
+
+/*================================================================================*/
+/*                                 Implementaions                                 */
+/*================================================================================*/
+
+	const double Statistics::bounds[buckets - 1] = {1, 2, 4, 8, 16, 33, 66};
+
+	Statistics & Statistics::instance()
+	{
+		static Statistics statistics;
+		return statistics;
+	}
+
+	void Statistics::add(Stage stage, std::chrono::steady_clock::duration time)
+	{
+		_ns[stage] += std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+	}
+
+	void Statistics::add(Counter counter, unsigned long amount)
+	{
+		_count[counter] += amount;
+	}
+
+	void Statistics::close_frame()
+	{
+		Frame frame;
+
+		for (int s = 0; s < STAGES; ++s)
+			frame.ms[s] = _ns[s].exchange(0) / 1e6;
+
+		for (int c = 0; c < COUNTERS; ++c)
+			frame.count[c] = _count[c].exchange(0);
+
+		std::lock_guard<std::mutex> guard(_lock);
+
+		_last = frame;
+
+		if (_frames.size() < Traits<Statistics>::frames)
+			_frames.push_back(frame.ms[FRAME]);
+		else
+			_frames[_next] = frame.ms[FRAME];
+
+		_next = (_next + 1) % Traits<Statistics>::frames;
+
+		DB(Statistics, TRC) << "Statistics: frame " << frame.ms[FRAME] << " ms" << std::endl;
+	}
+
+	Statistics::Frame Statistics::last() const
+	{
+		std::lock_guard<std::mutex> guard(_lock);
+		return _last;
+	}
+
+	std::vector<unsigned> Statistics::histogram() const
+	{
+		std::vector<unsigned> histogram(buckets, 0);
+		std::lock_guard<std::mutex> guard(_lock);
+
+		for (double ms : _frames)
+			++histogram[std::upper_bound(bounds, bounds + buckets - 1, ms) - bounds];
+
+		return histogram;
+	}
+
+	//! p in [0, 1] of the frame times kept
+	double Statistics::percentile(double p) const
+	{
+		std::vector<double> frames;
+
+		{
+			std::lock_guard<std::mutex> guard(_lock);
+			frames = _frames;
+		}
+
+		if (frames.empty())
+			return 0;
+
+		auto nth = frames.begin() + std::min(frames.size() - 1, size_t(p * frames.size()));
+		std::nth_element(frames.begin(), nth, frames.end());
+
+		return *nth;
+	}
+
+	const char * Statistics::name(Stage stage)
+	{
+		static const char * const names[STAGES] = {
+			"w_transformation", "perspective", "clipping", "record", "paint", "frame"
+		};
+
+		return names[stage];
+	}
+
+	const char * Statistics::name(Counter counter)
+	{
+		static const char * const names[COUNTERS] = {
+			"shapes_built", "shapes_culled", "faces_culled", "vertices_in", "vertices_out", "segments"
+		};
+
+		return names[counter];
+	}
+
+	//! One "name value" line per stage (ms) and counter, then the histogram
+	std::string Statistics::report() const
+	{
+		std::ostringstream out;
+		const Frame frame = last();
+
+		for (int s = 0; s < STAGES; ++s)
+			out << name(Stage(s)) << "_ms " << frame.ms[s] << "\n";
+
+		for (int c = 0; c < COUNTERS; ++c)
+			out << name(Counter(c)) << " " << frame.count[c] << "\n";
+
+		out << "frame_p50_ms " << percentile(0.5) << "\n";
+		out << "frame_p95_ms " << percentile(0.95) << "\n";
+
+		auto counts = histogram();
+
+		for (unsigned b = 0; b < buckets; ++b)
+		{
+			out << "histogram_";
+			out << (b < buckets - 1 ? "lt_" + std::to_string(int(bounds[b])) : "ge_" + std::to_string(int(bounds[b - 1])));
+			out << "_ms " << counts[b] << "\n";
+		}
+
+		return out.str();
+	}
+
+	bool Statistics::dump(const std::string & path) const
+	{
+		std::ofstream file(path);
+
+		file << report();
+
+		return bool(file);
+	}
+
+} //! namespace sys
+
+#endif  // SYS_STATISTICS_HPP
@@ -0,0 +1,294 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef SYS_THREAD_POOL_HPP
+#define SYS_THREAD_POOL_HPP
+
+/* External includes */
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Local includes */
+#include "../config/traits.hpp"
+#include "trace.hpp"
+
+namespace sys
+{
+
+/*================================================================================*/
+/*                                   Definitions                                  */
+/*================================================================================*/
+
+	/* Work-stealing pool: each worker pops its own queue and steals from the
+	 * others. Threads outside the pool (GTK, the pipeline) each get a queue
+	 * of their own, up to Traits<ThreadPool>::callers, and only help with
+	 * what they pushed: a load never runs frame work, nor the reverse. */
+	class ThreadPool
+	{
+	public:
+		using Task = std::function<void()>;
+
+		/* 0 threads: one per hardware thread */
+		explicit ThreadPool(unsigned threads = Traits<ThreadPool>::threads);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool &) = delete;
+		ThreadPool &operator=(const ThreadPool &) = delete;
+
+		/* Amount of threads that run tasks, counting the caller */
+		unsigned size() const;
+
+		/* Runs f(i) for i in [begin, end) in chunks of grain. The caller helps
+		 * while it finds a task, then sleeps until the last chunk is done. */
+		template<typename F>
+		void parallel_for(size_t begin, size_t end, size_t grain, const F & f);
+
+		static ThreadPool & instance();
+
+	private:
+		struct Queue
+		{
+			std::mutex lock;
+			std::deque<Task> tasks;
+		};
+
+		//! Chunks of a parallel_for not done yet, and its caller waiting for none
+		struct Join
+		{
+			std::mutex lock;
+			std::condition_variable done;
+			std::atomic<size_t> remaining;
+		};
+
+		unsigned self();
+
+		void push(Task task);
+		bool pop(unsigned self, Task & task);
+		void work(unsigned self);
+
+		std::vector<std::unique_ptr<Queue>> _queues; //!< One per worker, then the callers' ones
+		std::vector<std::thread> _workers;
+		unsigned _first_caller{0};                   //!< Queue of the first outside thread
+		std::atomic<unsigned> _callers{0};           //!< Outside threads given a queue so far
+
+		std::atomic<bool> _stop{false};
+		std::atomic<size_t> _pending{0};
+		std::mutex _sleep_lock;
+		std::condition_variable _wake;
+
+		static thread_local const ThreadPool * _owner;
+		static thread_local unsigned _index;
+	};
+
+/*================================================================================*/
+/*                                 Implementaions                                 */
+/*================================================================================*/
+
+	thread_local const ThreadPool * ThreadPool::_owner{nullptr};
+	thread_local unsigned ThreadPool::_index{0};
+
+	ThreadPool::ThreadPool(unsigned threads)
+	{
+		if (!threads)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+
+		/* The caller is one of the threads */
+		unsigned workers = threads - 1;
+
+		_first_caller = workers;
+
+		for (unsigned i = 0; i < workers + Traits<ThreadPool>::callers; ++i)
+			_queues.emplace_back(new Queue());
+
+		for (unsigned i = 0; i < workers; ++i)
+			_workers.emplace_back(&ThreadPool::work, this, i);
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> guard(_sleep_lock);
+			_stop = true;
+		}
+
+		_wake.notify_all();
+
+		for (auto & t : _workers)
+			t.join();
+	}
+
+	unsigned ThreadPool::size() const
+	{
+		return _workers.size() + 1;
+	}
+
+	ThreadPool & ThreadPool::instance()
+	{
+		static ThreadPool pool;
+		return pool;
+	}
+
+	unsigned ThreadPool::self()
+	{
+		/* First call from outside: the next callers' queue, shared past the last */
+		if (_owner != this)
+		{
+			_owner = this;
+			_index = _first_caller + _callers++ % Traits<ThreadPool>::callers;
+		}
+
+		return _index;
+	}
+
+	void ThreadPool::push(Task task)
+	{
+		Queue & q = *_queues[self()];
+
+		{
+			std::lock_guard<std::mutex> guard(q.lock);
+			q.tasks.push_back(std::move(task));
+		}
+
+		{
+			std::lock_guard<std::mutex> guard(_sleep_lock);
+			++_pending;
+		}
+
+		_wake.notify_one();
+	}
+
+	bool ThreadPool::pop(unsigned self, Task & task)
+	{
+		//! Callers only take back what they pushed
+		const size_t n = self < _first_caller ? _queues.size() : 1;
+
+		/* Own queue first (LIFO, cache-warm), then steal the oldest task of the others */
+		for (size_t k = 0; k < n; ++k)
+		{
+			Queue & q = *_queues[(self + k) % n];
+			std::lock_guard<std::mutex> guard(q.lock);
+
+			if (q.tasks.empty())
+				continue;
+
+			if (!k)
+			{
+				task = std::move(q.tasks.back());
+				q.tasks.pop_back();
+			}
+			else
+			{
+				task = std::move(q.tasks.front());
+				q.tasks.pop_front();
+			}
+
+			--_pending;
+			return true;
+		}
+
+		return false;
+	}
+
+	void ThreadPool::work(unsigned self)
+	{
+		_owner = this;
+		_index = self;
+
+		if (Traits<Trace>::enabled)
+			Trace::instance().name_thread("worker " + std::to_string(self));
+
+		Task task;
+
+		while (true)
+		{
+			if (pop(self, task))
+			{
+				task();
+				continue;
+			}
+
+			std::unique_lock<std::mutex> guard(_sleep_lock);
+			_wake.wait(guard, [this]() { return _stop || _pending > 0; });
+
+			if (_stop)
+				return;
+		}
+	}
+
+	template<typename F>
+	void ThreadPool::parallel_for(size_t begin, size_t end, size_t grain, const F & f)
+	{
+		if (end <= begin)
+			return;
+
+		grain = std::max<size_t>(grain, 1);
+
+		if (_workers.empty() || end - begin <= grain)
+		{
+			for (size_t i = begin; i < end; ++i)
+				f(i);
+
+			return;
+		}
+
+		Join join;
+		join.remaining = (end - begin + grain - 1) / grain;
+
+		for (size_t b = begin; b < end; b += grain)
+		{
+			const size_t e = std::min(end, b + grain);
+
+			push([&f, &join, b, e]() {
+				for (size_t i = b; i < e; ++i)
+					f(i);
+
+				//! Under the lock: join may be gone as soon as the caller sees 0
+				std::lock_guard<std::mutex> guard(join.lock);
+
+				if (!--join.remaining)
+					join.done.notify_one();
+			});
+		}
+
+		/* Help first: keeps nested parallel_for calls deadlock free. Once
+		 * nothing is left to take, the other chunks are all running. */
+		const unsigned index = self();
+		Task task;
+
+		while (join.remaining && pop(index, task))
+			task();
+
+		std::unique_lock<std::mutex> guard(join.lock);
+		join.done.wait(guard, [&join]() { return !join.remaining; });
+	}
+
+} //! namespace sys
+
+#endif  // SYS_THREAD_POOL_HPP
@@ -0,0 +1,268 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef SYS_TRACE_HPP
+#define SYS_TRACE_HPP
+
+/* External includes */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* Local includes */
+#include "../config/traits.hpp"
+
+namespace sys
+{
+
+/*================================================================================*/
+/*                                   Definitions                                  */
+/*================================================================================*/
+
+	/* Binary trace of timed spans: each thread appends to its own ring of the last
+	 * Traits<Trace>::events events, flushed as Chrome trace JSON (Perfetto loads it).
+	 * Names must outlive the trace: string literals. */
+	class Trace
+	{
+	public:
+		struct Event
+		{
+			const char * name;
+			uint64_t begin;    //!< ns since the trace started
+			uint64_t duration; //!< ns, or ~0 for an instant
+		};
+
+		static Trace & instance();
+
+		uint64_t now() const;
+
+		void complete(const char * name, uint64_t begin, uint64_t end);
+		void instant(const char * name);
+
+		/* Shown instead of the thread id */
+		void name_thread(const std::string & name);
+
+		/* Safe while threads still trace, but events written meanwhile may be torn */
+		bool flush(const std::string & path);
+
+	private:
+		struct Buffer
+		{
+			unsigned tid;
+			std::string name;
+			std::vector<Event> events;
+			std::atomic<uint64_t> head{0}; //!< Events ever written
+		};
+
+		Trace();
+
+		Buffer & local();
+		void append(const Event & event);
+
+		const std::chrono::steady_clock::time_point _start;
+
+		std::mutex _lock;
+		std::vector<std::unique_ptr<Buffer>> _buffers; //!< Kept after their thread ends
+
+		static thread_local Buffer * _local;
+	};
+
+	/* Traces its scope as one complete event. Empty when tracing is disabled. */
+	template<bool enabled>
+	class Select_Span
+	{
+	public:
+		explicit Select_Span(const char * name) :
+			_name(name),
+			_begin(Trace::instance().now())
+		{
+		}
+
+		Select_Span(Select_Span && span) :
+			_name(span._name),
+			_begin(span._begin)
+		{
+			span._name = nullptr;
+		}
+
+		~Select_Span()
+		{
+			if (_name)
+				Trace::instance().complete(_name, _begin, Trace::instance().now());
+		}
+
+		Select_Span(const Select_Span &) = delete;
+		Select_Span &operator=(const Select_Span &) = delete;
+
+	private:
+		const char * _name;
+		uint64_t _begin;
+	};
+
+	template<>
+	class Select_Span<false>
+	{
+	public:
+		explicit Select_Span(const char *) {}
+		~Select_Span() {} //!< Non-trivial, so spans don't warn as unused
+	};
+
+/*================================================================================*/
+/*                                 Implementaions                                 */
+/*================================================================================*/
+
+	thread_local Trace::Buffer * Trace::_local{nullptr};
+
+	Trace::Trace() :
+		_start(std::chrono::steady_clock::now())
+	{
+	}
+
+	Trace & Trace::instance()
+	{
+		static Trace trace;
+		return trace;
+	}
+
+	uint64_t Trace::now() const
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count();
+	}
+
+	//! The calling thread's ring, registered on first use
+	Trace::Buffer & Trace::local()
+	{
+		if (!_local)
+		{
+			std::lock_guard<std::mutex> guard(_lock);
+
+			_buffers.emplace_back(new Buffer());
+			_local = _buffers.back().get();
+			_local->tid = _buffers.size();
+			_local->name = "thread " + std::to_string(_local->tid);
+			_local->events.resize(Traits<Trace>::events);
+		}
+
+		return *_local;
+	}
+
+	void Trace::append(const Event & event)
+	{
+		Buffer & buffer = local();
+		const uint64_t head = buffer.head.load(std::memory_order_relaxed);
+
+		buffer.events[head % buffer.events.size()] = event;
+		buffer.head.store(head + 1, std::memory_order_release);
+	}
+
+	void Trace::complete(const char * name, uint64_t begin, uint64_t end)
+	{
+		append({name, begin, end - begin});
+	}
+
+	void Trace::instant(const char * name)
+	{
+		append({name, now(), ~uint64_t(0)});
+	}
+
+	void Trace::name_thread(const std::string & name)
+	{
+		Buffer & buffer = local();
+
+		std::lock_guard<std::mutex> guard(_lock);
+		buffer.name = name;
+	}
+
+	bool Trace::flush(const std::string & path)
+	{
+		std::ofstream file(path);
+		std::lock_guard<std::mutex> guard(_lock);
+
+		/* Names are literals or thread names: only quotes and backslashes to escape */
+		auto quoted = [](const std::string & text) {
+			std::string out = "\"";
+
+			for (char c : text)
+			{
+				if (c == '"' || c == '\\')
+					out += '\\';
+
+				out += c;
+			}
+
+			return out + "\"";
+		};
+
+		const char * separator = "\n";
+
+		//! Timestamps in µs, with ns digits
+		file << std::fixed << std::setprecision(3);
+		file << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+
+		for (auto & buffer : _buffers)
+		{
+			file << separator << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->tid
+			     << ", \"args\": {\"name\": " << quoted(buffer->name) << "}}";
+			separator = ",\n";
+
+			const uint64_t head = buffer->head.load(std::memory_order_acquire);
+			const uint64_t size = std::min<uint64_t>(head, buffer->events.size());
+
+			for (uint64_t i = head - size; i < head; ++i)
+			{
+				const Event & event = buffer->events[i % buffer->events.size()];
+
+				file << separator << "{\"name\": " << quoted(event.name) << ", \"pid\": 1, \"tid\": " << buffer->tid
+				     << ", \"ts\": " << event.begin / 1e3;
+
+				if (event.duration == ~uint64_t(0))
+					file << ", \"ph\": \"i\", \"s\": \"t\"}";
+				else
+					file << ", \"ph\": \"X\", \"dur\": " << event.duration / 1e3 << "}";
+			}
+		}
+
+		file << "\n]}\n";
+
+		return bool(file);
+	}
+
+} //! namespace sys
+
+/* Spans of T's code, when T is debugged and tracing enabled:
+ *   auto span = trace<model::Line>("Line::clipping"); */
+template<typename T>
+inline sys::Select_Span<(Traits<T>::debugged && Traits<sys::Trace>::enabled)>
+trace(const char * name)
+{
+	return sys::Select_Span<(Traits<T>::debugged && Traits<sys::Trace>::enabled)>(name);
+}
+
+#endif  // SYS_TRACE_HPP
@@ -0,0 +1,242 @@
+/* The MIT License
+ *
+ * Copyright (c) 2019 João Vicente Souto and Bruno Izaias Bonotto
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Renders OBJ models into PNG files without a display:
+ *
+ *   render [--size WxH] [--fit] [--out FILE.png|DIR] [--backend cairo|raster] [--solid] [--cull] [--overlay] [--stats FILE] [--trace FILE] model.obj...
+ *
+ * --overlay and --stats need Traits<sys::Statistics>::enabled, --trace needs
+ * Traits<sys::Trace>::enabled.
+ */
+
+/* External includes */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+#include <cairomm/context.h>
+#include <cairomm/surface.h>
+
+/* Local includes */
+#include "../src/config/traits.hpp"
+#include "../src/control/object_loader.hpp"
+#include "../src/control/renderer.hpp"
+#include "../src/model/frame.hpp"
+#include "../src/model/viewport.hpp"
+#include "../src/model/window.hpp"
+#include "../src/sys/statistics.hpp"
+#include "../src/sys/trace.hpp"
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	double ms(Clock::time_point begin, Clock::time_point end)
+	{
+		return std::chrono::duration<double, std::milli>(end - begin).count();
+	}
+
+	/* Window transformation centering the x, y bounds of the loaded vertices */
+	model::Matrix fit(const std::vector<std::shared_ptr<model::Shape>> & shapes, double width, double height)
+	{
+		double lo[2] = { std::numeric_limits<double>::max(),  std::numeric_limits<double>::max()};
+		double hi[2] = {-std::numeric_limits<double>::max(), -std::numeric_limits<double>::max()};
+
+		for (auto & shape : shapes)
+			if (auto buffer = shape->buffer())
+				for (int c = 0; c < 2; ++c)
+					for (size_t i = 0; i < buffer->size(); ++i)
+					{
+						lo[c] = std::min(lo[c], buffer->coordinates(c)[i]);
+						hi[c] = std::max(hi[c], buffer->coordinates(c)[i]);
+					}
+
+		if (lo[0] > hi[0])
+			return model::Matrix();
+
+		const double s = 0.9 * std::min(width / std::max(hi[0] - lo[0], 1e-9), height / std::max(hi[1] - lo[1], 1e-9));
+		const double x = (lo[0] + hi[0]) / 2;
+		const double y = (lo[1] + hi[1]) / 2;
+
+		return model::Matrix(
+			{     s,      0, 0, 0},
+			{     0,      s, 0, 0},
+			{     0,      0, 1, 0},
+			{-s * x, -s * y, 0, 1}
+		);
+	}
+
+	std::string output_of(const std::string & model, const std::string & out, bool single)
+	{
+		if (single && out.size() > 4 && out.compare(out.size() - 4, 4, ".png") == 0)
+			return out;
+
+		std::string name = model.substr(model.find_last_of('/') + 1);
+		name = name.substr(0, name.find_last_of('.')) + ".png";
+
+		return out.empty() ? name : out + "/" + name;
+	}
+}
+
+int main(int argc, char ** argv)
+{
+	int width = 800, height = 600;
+	bool fitted = false, overlay = false;
+	std::string out, stats, traced;
+	std::vector<std::string> models;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "--size") && i + 1 < argc)
+		{
+			if (std::sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0)
+			{
+				std::cerr << "render: bad size " << argv[i] << std::endl;
+				return 1;
+			}
+		}
+		else if (!std::strcmp(argv[i], "--out") && i + 1 < argc)
+			out = argv[++i];
+		else if (!std::strcmp(argv[i], "--fit"))
+			fitted = true;
+		else if (!std::strcmp(argv[i], "--backend") && i + 1 < argc)
+		{
+			const char * backend = argv[++i];
+
+			if (!std::strcmp(backend, "cairo"))
+				model::Backend::kind = model::Backend::Kind::Cairo;
+			else if (!std::strcmp(backend, "raster"))
+				model::Backend::kind = model::Backend::Kind::Raster;
+			else
+			{
+				std::cerr << "render: bad backend " << backend << std::endl;
+				return 1;
+			}
+		}
+		else if (!std::strcmp(argv[i], "--solid"))
+			control::ObjectLoader::filled = true;
+		else if (!std::strcmp(argv[i], "--cull"))
+			model::Polygon::back_face_culling = true;
+		else if (!std::strcmp(argv[i], "--overlay"))
+			overlay = true;
+		else if (!std::strcmp(argv[i], "--stats") && i + 1 < argc)
+			stats = argv[++i];
+		else if (!std::strcmp(argv[i], "--trace") && i + 1 < argc)
+			traced = argv[++i];
+		else
+			models.push_back(argv[i]);
+	}
+
+	if (models.empty())
+	{
+		std::cerr << "usage: render [--size WxH] [--fit] [--out FILE.png|DIR] [--backend cairo|raster] [--solid] [--cull] [--overlay] [--stats FILE] [--trace FILE] model.obj..." << std::endl;
+		return 1;
+	}
+
+	int failures = 0;
+	std::ofstream report;
+
+	if (!stats.empty())
+		report.open(stats);
+
+	for (auto & path : models)
+	{
+		/* Same window the GUI builds for a width x height drawing area */
+		model::Window window(model::Vector(-width / 2.0, -height / 2.0, 0), model::Vector(width / 2.0, height / 2.0, 0));
+		control::Renderer renderer(window);
+
+		auto span = trace<control::Renderer>("render::model");
+		auto t0 = Clock::now();
+
+		control::ObjectLoader loader;
+		auto shapes = loader.load(path, window.min(), window.max());
+
+		if (shapes.empty())
+		{
+			std::cerr << "render: nothing loaded from " << path << std::endl;
+			++failures;
+			continue;
+		}
+
+		if (fitted)
+			window.transformation(fit(shapes, width, height));
+
+		//! The window border is drawn as in the GUI; the window owns it
+		shapes.emplace(shapes.begin(), &window.drawable(), [](model::Shape *) {});
+
+		auto t1 = Clock::now();
+
+		model::Frame frame;
+
+		{
+			sys::Timer timer(sys::Statistics::FRAME);
+			renderer.render(shapes, frame);
+		}
+
+		auto t2 = Clock::now();
+
+		auto surface = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, width, height);
+		auto cr = Cairo::Context::create(surface);
+
+		model::Viewport::paint(cr, frame, width, height);
+
+		auto t3 = Clock::now();
+
+		if (Traits<sys::Statistics>::enabled)
+		{
+			sys::Statistics::instance().close_frame();
+
+			/* Painted again, now with this frame's numbers over it */
+			if (overlay)
+				model::Viewport::paint(cr, frame, width, height, true);
+
+			if (report.is_open())
+				report << "model " << path << "\n" << sys::Statistics::instance().report();
+		}
+
+		surface->flush();
+
+		const std::string png = output_of(path, out, models.size() == 1);
+		surface->write_to_png(png);
+
+		std::cout << "render: " << path << " -> " << png << ", "
+		          << shapes.size() - 1 << " objects, load "
+		          << ms(t0, t1) << " ms, build "
+		          << ms(t1, t2) << " ms, draw "
+		          << ms(t2, t3) << " ms" << std::endl;
+	}
+
+	if (Traits<sys::Trace>::enabled && !traced.empty() && !sys::Trace::instance().flush(traced))
+	{
+		std::cerr << "render: unable to write " << traced << std::endl;
+		++failures;
+	}
+
+	return failures ? 1 : 0;
+}